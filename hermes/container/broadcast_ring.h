@@ -0,0 +1,201 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+
+namespace hermes::container {
+
+/**
+ * Single Producer Broadcast Ring
+ *
+ * Every value written by the producer is seen by every subscribed reader.
+ * Readers keep their own cache line padded cursor and read values in place,
+ * the producer only overwrites a slot once the slowest reader moved past it.
+ * Readers can subscribe and unsubscribe at any time, a new reader starts at
+ * the current write position. MAX_SIZE must be a power of two
+ */
+template <typename T, uint32_t MAX_SIZE, uint32_t MAX_READERS = 16>
+class BroadcastRing {
+  static_assert(MAX_SIZE >= 2 && (MAX_SIZE & (MAX_SIZE - 1)) == 0,
+                "BroadcastRing capacity must be a power of two");
+
+ public:
+  using ReaderId = uint32_t;
+  static constexpr ReaderId INVALID_READER = MAX_READERS;
+
+ public:
+  BroadcastRing(const BroadcastRing &_) = delete;
+  BroadcastRing &operator=(const BroadcastRing &_) = delete;
+
+  BroadcastRing() {
+    data_ = static_cast<T *>(operator new[](sizeof(T) * MAX_SIZE));
+    write_index_ = 0;
+    min_read_cache_ = 0;
+
+    for (auto &cursor : cursors_) {
+      cursor.read_index = 0;
+      cursor.active = false;
+    }
+  }
+
+  ~BroadcastRing() {
+    const auto written = write_index_.load(std::memory_order_relaxed);
+    const auto constructed = std::min<uint64_t>(written, MAX_SIZE);
+    for (uint64_t i = 0; i < constructed; ++i) data_[i].~T();
+    operator delete[](data_);
+  }
+
+ public:
+  // Emplace value at the begin of the ring, fails when the slowest reader is
+  // a full ring behind
+  // Only producer thread should call this method
+  template <typename... Args>
+  bool Write(Args &&...args) {
+    const auto curr_write = write_index_.load(std::memory_order_relaxed);
+
+    if (curr_write - min_read_cache_ >= MAX_SIZE) [[unlikely]] {
+      min_read_cache_ = MinReadIndex(curr_write);
+      if (curr_write - min_read_cache_ >= MAX_SIZE) return false;
+    }
+
+    auto *slot = data_ + (curr_write & MASK);
+    if (curr_write >= MAX_SIZE) slot->~T();
+    new (slot) T{std::forward<decltype(args)>(args)...};
+
+    write_index_.store(curr_write + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Register a reader starting at the current write position, returns
+  // INVALID_READER when all MAX_READERS cursors are taken
+  // Any thread can call this method
+  ReaderId Subscribe() noexcept {
+    for (ReaderId id = 0; id < MAX_READERS; ++id) {
+      auto &cursor = cursors_[id];
+      bool expected = false;
+      if (cursor.claimed.compare_exchange_strong(expected, true,
+                                                 std::memory_order_acq_rel)) {
+        // publish a read index the producer has not passed yet before the
+        // real start, the producer holds back from here on
+        const auto guess = write_index_.load(std::memory_order_acquire);
+        cursor.read_index.store(guess, std::memory_order_relaxed);
+        cursor.active.store(true, std::memory_order_relaxed);
+
+        // pairs with the fence in MinReadIndex, either the producer sees this
+        // reader or the load below sees every slot the producer was allowed
+        // to overwrite without it
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        const auto curr_write = write_index_.load(std::memory_order_acquire);
+        cursor.read_index.store(curr_write, std::memory_order_release);
+        cursor.write_index_cache = curr_write;
+        return id;
+      }
+    }
+    return INVALID_READER;
+  }
+
+  // Only the reader owning id should call this method
+  void Unsubscribe(const ReaderId id) noexcept {
+    auto &cursor = cursors_[id];
+    cursor.active.store(false, std::memory_order_release);
+    cursor.claimed.store(false, std::memory_order_release);
+  }
+
+  // Copy the next value for reader id
+  // Only the reader owning id should call this method
+  bool Read(const ReaderId id, T &record) {
+    return ConsumeOne(id, [&](const T &value) { record = value; });
+  }
+
+  // Invoke functor on the next value for reader id in place
+  // Only the reader owning id should call this method
+  template <typename Functor>
+  bool ConsumeOne(const ReaderId id, const Functor &functor) {
+    auto &cursor = cursors_[id];
+    const auto curr_read = cursor.read_index.load(std::memory_order_relaxed);
+
+    if (curr_read == cursor.write_index_cache) {
+      cursor.write_index_cache = write_index_.load(std::memory_order_acquire);
+      if (curr_read == cursor.write_index_cache) return false;
+    }
+
+    functor(static_cast<const T &>(data_[curr_read & MASK]));
+    cursor.read_index.store(curr_read + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Invoke functor in place on every value available to reader id at call
+  // time, the reader cursor is published once for the whole batch
+  // Only the reader owning id should call this method
+  template <typename Functor>
+  size_t ConsumeAll(const ReaderId id, const Functor &functor) {
+    auto &cursor = cursors_[id];
+    const auto curr_write = write_index_.load(std::memory_order_acquire);
+    auto curr_read = cursor.read_index.load(std::memory_order_relaxed);
+
+    const auto start = curr_read;
+    for (; curr_read != curr_write; ++curr_read)
+      functor(static_cast<const T &>(data_[curr_read & MASK]));
+
+    cursor.write_index_cache = curr_write;
+    if (curr_read != start)
+      cursor.read_index.store(curr_read, std::memory_order_release);
+    return curr_read - start;
+  }
+
+  // Number of values reader id has not consumed yet
+  size_t LagGuess(const ReaderId id) const noexcept {
+    const auto curr_read =
+        cursors_[id].read_index.load(std::memory_order_acquire);
+    const auto curr_write = write_index_.load(std::memory_order_acquire);
+    return curr_write - curr_read;
+  }
+
+  static constexpr uint32_t Capacity() noexcept { return MAX_SIZE; }
+
+ private:
+  // Slowest active reader, or curr_write when nobody is subscribed
+  uint64_t MinReadIndex(const uint64_t curr_write) const noexcept {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    auto ret = curr_write;
+    for (const auto &cursor : cursors_) {
+      if (cursor.active.load(std::memory_order_acquire))
+        ret = std::min(ret, cursor.read_index.load(std::memory_order_acquire));
+    }
+    return ret;
+  }
+
+ private:
+  static constexpr uint64_t MASK = MAX_SIZE - 1;
+
+  using AtomicIndex = std::atomic<uint64_t>;
+  static constexpr std::size_t CACHE_LINE_SIZE =
+#ifdef __cpp_lib_hardware_interference_size
+      std::hardware_destructive_interference_size;
+#else
+      64;
+#endif
+
+  // reader owned cache line
+  struct alignas(CACHE_LINE_SIZE) ReaderCursor {
+    AtomicIndex read_index;
+    uint64_t write_index_cache{0};
+    std::atomic<bool> active{false};
+    std::atomic<bool> claimed{false};
+  };
+
+ private:
+  T *data_;
+
+  // producer owned cache line
+  alignas(CACHE_LINE_SIZE) AtomicIndex write_index_;
+  uint64_t min_read_cache_;
+
+  ReaderCursor cursors_[MAX_READERS];
+};
+
+}  // namespace hermes::container
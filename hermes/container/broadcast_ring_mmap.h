@@ -0,0 +1,391 @@
+#pragma once
+
+#include <glog/logging.h>
+#include <signal.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <new>
+#include <string>
+#include <type_traits>
+
+#include "hermes/container/mmap_file.h"
+
+namespace hermes::container {
+
+namespace detail {
+
+/**
+ * Layout shared by the writer and every reader process of a broadcast ring
+ *
+ *   line 0          : MMapBroadcastMeta, written once when the file is created
+ *   line 1          : writer index
+ *   line 2 .. 2 + R : one MMapReaderCursor per reader
+ *   data            : capacity slots, a sequence number followed by the value
+ */
+struct MMapBroadcastMeta : MMapMeta {
+  static constexpr uint64_t MAGIC = 0x52424d5345524d48;  // "HMRESMBR"
+  static constexpr uint32_t VERSION = 2;
+
+  uint32_t max_readers;
+};
+
+struct alignas(64) MMapReaderCursor {
+  static constexpr uint32_t FREE = 0;
+  static constexpr uint32_t ACTIVE = 1;
+  // taken by a subscriber that is still filling in the cursor
+  static constexpr uint32_t CLAIMING = 2;
+
+  static constexpr uint64_t Owner(const int32_t pid,
+                                  const uint32_t state) noexcept {
+    return uint64_t(uint32_t(pid)) << 32 | state;
+  }
+  static constexpr int32_t Pid(const uint64_t owner) noexcept {
+    return static_cast<int32_t>(owner >> 32);
+  }
+  static constexpr uint32_t State(const uint64_t owner) noexcept {
+    return static_cast<uint32_t>(owner);
+  }
+
+  // pid and state of the owning reader in one word, claimed with a single
+  // CAS so a cursor is never taken without the pid of its owner
+  std::atomic<uint64_t> owner;
+  std::atomic<uint64_t> read_index;
+  // values the reader lost because the writer lapped it
+  std::atomic<uint64_t> dropped;
+};
+
+}  // namespace detail
+
+/**
+ * Single Producer Broadcast Ring mmap file backed
+ *
+ * One writer process publishes and up to MAX_READERS reader processes read
+ * every value from the same mapping. Each reader copies each value once out
+ * of the shared mapping, the seqlock validation of a slot needs the copy to
+ * detect a concurrent overwrite. Readers subscribe and unsubscribe at any
+ * time and keep their cursor in the header so the writer and monitoring
+ * tools can see how far behind they are.
+ *
+ * Unlike BroadcastRing the writer never waits for readers: every slot
+ * carries the sequence number of its value, a reader that was lapped by the
+ * writer detects it from the sequence number, skips to the newest value and
+ * accounts the lost values in Dropped()
+ */
+template <typename T, uint32_t MAX_READERS = 16>
+class BroadcastRingMMap {
+  static_assert(std::is_trivially_copyable<T>::value,
+                "BroadcastRingMMap values are shared across processes and "
+                "must be trivially copyable");
+  static_assert(MAX_READERS > 0, "BroadcastRingMMap needs at least a reader");
+
+ public:
+  using ReaderId = uint32_t;
+  static constexpr ReaderId INVALID_READER = MAX_READERS;
+
+ public:
+  BroadcastRingMMap(const BroadcastRingMMap &_) = delete;
+  BroadcastRingMMap &operator=(const BroadcastRingMMap &_) = delete;
+
+  BroadcastRingMMap() {}
+
+ public:
+  // Map the ring file at file_path, same sizing, reattach and attach
+  // timeout rules as SpscQueueMMap::Init. Returns false when the ring could
+  // not be attached
+  bool Init(const std::string &file_path, const size_t file_size,
+            const bool reset, const MMapOptions &options = {}) noexcept {
+    LOG(INFO) << "Initializing broadcast_ring at path: " << file_path;
+    HEADER.CheckFileSize(file_size, sizeof(Slot));
+    return Attach(file_.Open(file_path, file_size, reset, options),
+                  file_path);
+  }
+
+  // Same as Init on the POSIX shared memory object shm_name
+  bool InitShm(const std::string &shm_name, const size_t file_size,
+               const bool reset, const MMapOptions &options = {}) noexcept {
+    LOG(INFO) << "Initializing broadcast_ring at shm: " << shm_name;
+    HEADER.CheckFileSize(file_size, sizeof(Slot));
+    return Attach(file_.OpenShm(shm_name, file_size, reset, options),
+                  shm_name);
+  }
+
+  // Publish value, overwriting the oldest one whether every reader consumed
+  // it or not
+  // Only writer process should call this method
+  void Write(const T &value) noexcept {
+    const auto curr_write = write_index_cache_;
+    auto &slot = SlotAt(curr_write);
+
+    // odd sequence marks the slot as being written, readers of the previous
+    // value in this slot see it changed and drop their copy
+    slot.seq.store(2 * curr_write + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(&slot.value, &value, sizeof(T));
+    slot.seq.store(2 * curr_write + 2, std::memory_order_release);
+
+    write_index_cache_ = curr_write + 1;
+    write_index_->store(curr_write + 1, std::memory_order_release);
+  }
+
+  // Register a reader starting at the current write position, returns
+  // INVALID_READER when all MAX_READERS cursors are taken
+  // Any process can call this method
+  ReaderId Subscribe() noexcept {
+    using Cursor = detail::MMapReaderCursor;
+    const auto pid = getpid();
+
+    for (ReaderId id = 0; id < MAX_READERS; ++id) {
+      auto &cursor = cursors_[id];
+      auto owner = cursor.owner.load(std::memory_order_relaxed);
+      if (Cursor::State(owner) != Cursor::FREE) continue;
+
+      // claimed together with our pid, a subscriber dying before ACTIVE
+      // leaves a CLAIMING cursor ReleaseDeadReaders can reclaim
+      if (cursor.owner.compare_exchange_strong(
+              owner, Cursor::Owner(pid, Cursor::CLAIMING),
+              std::memory_order_acq_rel)) {
+        cursor.dropped.store(0, std::memory_order_relaxed);
+        cursor.read_index.store(write_index_->load(std::memory_order_acquire),
+                                std::memory_order_relaxed);
+        cursor.owner.store(Cursor::Owner(pid, Cursor::ACTIVE),
+                           std::memory_order_release);
+        return id;
+      }
+    }
+    return INVALID_READER;
+  }
+
+  // Only the reader owning id should call this method
+  void Unsubscribe(const ReaderId id) noexcept {
+    cursors_[id].owner.store(
+        detail::MMapReaderCursor::Owner(0, detail::MMapReaderCursor::FREE),
+        std::memory_order_release);
+  }
+
+  // Free the cursors of readers whose process exited without unsubscribing,
+  // also in the middle of Subscribe, returns how many were freed
+  // Any process can call this method
+  uint32_t ReleaseDeadReaders() noexcept {
+    using Cursor = detail::MMapReaderCursor;
+
+    uint32_t released = 0;
+    for (ReaderId id = 0; id < MAX_READERS; ++id) {
+      auto &cursor = cursors_[id];
+      auto owner = cursor.owner.load(std::memory_order_acquire);
+      if (Cursor::State(owner) == Cursor::FREE) continue;
+
+      // kill(0, 0) would probe our own process group instead
+      const auto pid = Cursor::Pid(owner);
+      if (pid <= 0) continue;
+      if (kill(pid, 0) == 0 || errno != ESRCH) continue;
+
+      // only one process wins the release, and a cursor reused by a new
+      // reader since the load carries another owner and is left alone
+      if (!cursor.owner.compare_exchange_strong(
+              owner, Cursor::Owner(0, Cursor::FREE),
+              std::memory_order_acq_rel))
+        continue;
+
+      LOG(WARNING) << "Releasing broadcast_ring reader of dead pid " << pid;
+      released += 1;
+    }
+    return released;
+  }
+
+  // Copy the next value for reader id. A lapped reader skips to the newest
+  // value first, see Dropped
+  // Only the reader owning id should call this method
+  bool Read(const ReaderId id, T &record) noexcept {
+    auto &cursor = cursors_[id];
+    auto curr_read = cursor.read_index.load(std::memory_order_relaxed);
+
+    while (true) {
+      switch (TryCopy(curr_read, &record)) {
+        case CopyResult::EMPTY:
+          return false;
+        case CopyResult::OVERRUN:
+          curr_read = Resync(cursor, curr_read);
+          continue;
+        case CopyResult::OK:
+          cursor.read_index.store(curr_read + 1, std::memory_order_release);
+          return true;
+      }
+    }
+  }
+
+  // Invoke functor on a copy of every value available to reader id at call
+  // time, the reader cursor is published once for the whole batch
+  // Only the reader owning id should call this method
+  template <typename Functor>
+  size_t ConsumeAll(const ReaderId id, const Functor &functor) {
+    auto &cursor = cursors_[id];
+    auto curr_read = cursor.read_index.load(std::memory_order_relaxed);
+    auto curr_write = write_index_->load(std::memory_order_acquire);
+    const auto start = curr_read;
+
+    // raw storage, T needs no default constructor
+    size_t count = 0;
+    alignas(T) unsigned char record[sizeof(T)];
+    while (curr_read < curr_write) {
+      const auto result = TryCopy(curr_read, record);
+      if (result == CopyResult::EMPTY) break;
+      if (result == CopyResult::OVERRUN) {
+        curr_read = Resync(cursor, curr_read);
+        curr_write = std::max(curr_write, curr_read + 1);
+        continue;
+      }
+
+      functor(*std::launder(reinterpret_cast<const T *>(record)));
+      curr_read += 1;
+      count += 1;
+    }
+
+    if (curr_read != start)
+      cursor.read_index.store(curr_read, std::memory_order_release);
+    return count;
+  }
+
+  // Number of values reader id has not consumed yet, more than Capacity()
+  // means the reader is being lapped
+  size_t LagGuess(const ReaderId id) const noexcept {
+    const auto curr_read =
+        cursors_[id].read_index.load(std::memory_order_acquire);
+    const auto curr_write = write_index_->load(std::memory_order_acquire);
+    return curr_write - curr_read;
+  }
+
+  // Number of values reader id lost because the writer lapped it
+  uint64_t Dropped(const ReaderId id) const noexcept {
+    return cursors_[id].dropped.load(std::memory_order_relaxed);
+  }
+
+  bool IsSubscribed(const ReaderId id) const noexcept {
+    return detail::MMapReaderCursor::State(cursors_[id].owner.load(
+               std::memory_order_acquire)) == detail::MMapReaderCursor::ACTIVE;
+  }
+
+  size_t Capacity() const noexcept { return capacity_; }
+
+ private:
+  enum class CopyResult { OK, EMPTY, OVERRUN };
+
+  struct Slot {
+    std::atomic<uint64_t> seq;
+    T value;
+  };
+
+  // Seqlock read of the value at index into the sizeof(T) bytes at record
+  CopyResult TryCopy(const uint64_t index, void *record) const noexcept {
+    const auto &slot = SlotAt(index);
+    const auto expected = 2 * index + 2;
+
+    const auto seq = slot.seq.load(std::memory_order_acquire);
+    if (seq < expected) return CopyResult::EMPTY;
+    if (seq > expected) return CopyResult::OVERRUN;
+
+    std::memcpy(record, &slot.value, sizeof(T));
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot.seq.load(std::memory_order_relaxed) != expected)
+      return CopyResult::OVERRUN;
+    return CopyResult::OK;
+  }
+
+  // Move a lapped reader to the newest value and account what it lost
+  uint64_t Resync(detail::MMapReaderCursor &cursor,
+                  const uint64_t curr_read) noexcept {
+    const auto curr_write = write_index_->load(std::memory_order_acquire);
+    const auto next_read = curr_write > 0 ? curr_write - 1 : 0;
+    cursor.dropped.fetch_add(next_read - curr_read, std::memory_order_relaxed);
+    return next_read;
+  }
+
+  Slot &SlotAt(const uint64_t index) const noexcept {
+    return data_[index & mask_];
+  }
+
+  bool Attach(const bool create, const std::string &name) noexcept {
+    mmap_ptr_ = file_.Data();
+    file_size_ = file_.Size();
+
+    meta_ = reinterpret_cast<detail::MMapBroadcastMeta *>(mmap_ptr_);
+    write_index_ = reinterpret_cast<AtomicIndex *>(mmap_ptr_ + CACHE_LINE);
+    cursors_ = reinterpret_cast<detail::MMapReaderCursor *>(mmap_ptr_ +
+                                                             2 * CACHE_LINE);
+    data_ = reinterpret_cast<Slot *>(mmap_ptr_ + HEADER_SIZE);
+
+    if (create)
+      CreateHeader();
+    else if (!ValidateHeader(name))
+      return false;
+
+    capacity_ = meta_->capacity;
+    mask_ = capacity_ - 1;
+    write_index_cache_ = write_index_->load(std::memory_order_acquire);
+
+    LOG(INFO) << "Successfully initialized broadcast_ring at " << name
+              << ", capacity = " << capacity_
+              << ", max readers = " << MAX_READERS;
+    return true;
+  }
+
+  void CreateHeader() noexcept {
+    const auto capacity = HEADER.MaskCapacity(file_size_, sizeof(Slot));
+    HEADER.Create(file_, capacity);
+    meta_->max_readers = MAX_READERS;
+
+    new (write_index_) AtomicIndex{0};
+    for (uint32_t id = 0; id < MAX_READERS; ++id)
+      new (cursors_ + id) detail::MMapReaderCursor{};
+    for (uint64_t i = 0; i < capacity; ++i) new (&data_[i].seq) AtomicIndex{0};
+
+    HEADER.Publish(file_);
+  }
+
+  bool ValidateHeader(const std::string &name) noexcept {
+    if (!HEADER.Validate(file_, name,
+                         [&] { return meta_->capacity * sizeof(Slot); }))
+      return false;
+
+    if (meta_->max_readers != MAX_READERS) {
+      LOG(ERROR) << "Reader count mismatch, file has " << meta_->max_readers
+                 << " readers, expected " << MAX_READERS;
+      return false;
+    }
+    return true;
+  }
+
+ private:
+  static constexpr size_t CACHE_LINE = 64;
+  static constexpr size_t HEADER_SIZE = (2 + MAX_READERS) * CACHE_LINE;
+  static constexpr MMapHeader HEADER{
+      "broadcast_ring", detail::MMapBroadcastMeta::MAGIC,
+      detail::MMapBroadcastMeta::VERSION, sizeof(T), HEADER_SIZE};
+
+  using AtomicIndex = std::atomic<uint64_t>;
+  static_assert(AtomicIndex::is_always_lock_free,
+                "shared memory indices must be lock free");
+  static_assert(sizeof(detail::MMapReaderCursor) == CACHE_LINE,
+                "every reader cursor owns a header cache line");
+
+ private:
+  MMapFile file_;
+  size_t file_size_{0};
+  char *mmap_ptr_{nullptr};
+
+  detail::MMapBroadcastMeta *meta_{nullptr};
+  Slot *data_{nullptr};
+  uint64_t capacity_{0};
+  uint64_t mask_{0};
+
+  AtomicIndex *write_index_{nullptr};
+  detail::MMapReaderCursor *cursors_{nullptr};
+
+  // process local copy of the writer index, only used by the writer
+  uint64_t write_index_cache_{0};
+};
+
+}  // namespace hermes::container
@@ -0,0 +1,418 @@
+#pragma once
+
+#include <fcntl.h>
+#include <glog/logging.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <thread>
+
+namespace hermes::container {
+
+/**
+ * Page residency controls applied right after a file is mapped
+ */
+struct MMapOptions {
+  enum class Advice { NONE, SEQUENTIAL, RANDOM, HUGEPAGE };
+
+  // Fault every page in for writing so the hot path never page faults
+  bool prefault{false};
+
+  // Pin the mapping in RAM, needs a large enough RLIMIT_MEMLOCK
+  bool lock{false};
+
+  Advice advice{Advice::NONE};
+};
+
+/**
+ * Shared read-write mapping of a whole file, the building block of the mmap
+ * backed containers. The file is either a path on a file system, a POSIX
+ * shared memory object or an anonymous memfd; the last two live in memory
+ * only and never pay for dirty page writeback
+ */
+class MMapFile {
+ public:
+  MMapFile(const MMapFile &_) = delete;
+  MMapFile &operator=(const MMapFile &_) = delete;
+
+  MMapFile() {}
+
+  ~MMapFile() { Close(); }
+
+ public:
+  // Map the file at path. The file is resized to size when reset is set or
+  // when it is empty, otherwise its current size is kept. Returns true when
+  // the file was (re)sized and its header needs to be written, of processes
+  // opening a new file at the same time only one gets true
+  bool Open(const std::string &path, const size_t size, const bool reset,
+            const MMapOptions &options = {}) noexcept {
+    Close();
+
+    const int fd = open(path.c_str(), O_RDWR | O_CREAT, 0666);
+    CHECK(fd != -1) << "Error opening file at path: " << path;
+    return Map(fd, size, reset, options);
+  }
+
+  // Map the existing file at path read-only, it is never created or resized.
+  // Returns false when the file does not exist or is empty
+  bool OpenReadOnly(const std::string &path) noexcept {
+    Close();
+
+    const int fd = open(path.c_str(), O_RDONLY);
+    if (fd == -1) return false;
+
+    struct stat stat_buf;
+    CHECK(fstat(fd, &stat_buf) == 0) << "Error getting file size";
+    if (stat_buf.st_size == 0) {
+      close(fd);
+      return false;
+    }
+
+    fd_ = fd;
+    size_ = stat_buf.st_size;
+    data_ = static_cast<char *>(
+        mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd_, 0));
+    CHECK(data_ != MAP_FAILED) << "Error mapping file at path: " << path;
+    return true;
+  }
+
+  // Map the POSIX shared memory object name (e.g. "/hermes_queue"), it lives
+  // in tmpfs and is never written back to disk. Same sizing rules as Open
+  bool OpenShm(const std::string &name, const size_t size, const bool reset,
+               const MMapOptions &options = {}) noexcept {
+    Close();
+
+    const int fd = shm_open(name.c_str(), O_RDWR | O_CREAT, 0666);
+    CHECK(fd != -1) << "Error opening shared memory object: " << name;
+    return Map(fd, size, reset, options);
+  }
+
+  // Map a new anonymous memory file of size bytes. It has no name to attach
+  // to, other processes get it by fork or by ReceiveFd of Fd()
+  bool OpenMemfd(const std::string &name, const size_t size,
+                 const MMapOptions &options = {}) noexcept {
+    Close();
+
+    const int fd = memfd_create(name.c_str(), MFD_CLOEXEC);
+    CHECK(fd != -1) << "Error creating memfd: " << name;
+    return Map(fd, size, true, options);
+  }
+
+  // Map an already open fd, e.g. one received with ReceiveFd, and take
+  // ownership of it. Same sizing rules as Open
+  bool OpenFd(const int fd, const size_t size, const bool reset,
+              const MMapOptions &options = {}) noexcept {
+    Close();
+
+    CHECK(fd != -1) << "Invalid fd";
+    return Map(fd, size, reset, options);
+  }
+
+  // Apply madvise hints, mlock and prefaulting to the mapping, in that order
+  // so huge page hints are in place before the first fault
+  void Apply(const MMapOptions &options) noexcept {
+    if (options.advice != MMapOptions::Advice::NONE &&
+        madvise(data_, size_, ToMadvise(options.advice)) != 0)
+      LOG(WARNING) << "madvise failed on mmap file data";
+
+    const auto start = std::chrono::steady_clock::now();
+
+    if (options.lock && mlock(data_, size_) != 0)
+      LOG(WARNING) << "mlock failed on mmap file data, check RLIMIT_MEMLOCK";
+
+    if (options.prefault) Prefault();
+
+    prefault_time_ = std::chrono::steady_clock::now() - start;
+    if (options.lock || options.prefault)
+      LOG(INFO) << "Prefaulted " << size_ << " bytes of mmap file data in "
+                << std::chrono::duration_cast<std::chrono::microseconds>(
+                       prefault_time_)
+                       .count()
+                << " us";
+  }
+
+  void Close() noexcept {
+    if (data_ == nullptr) return;
+
+    LOG(INFO) << "Closing mmap file data";
+
+    munmap(data_, size_);
+    close(fd_);
+
+    data_ = nullptr;
+    fd_ = -1;
+  }
+
+  // Reserve disk blocks for the whole file so later writes through the
+  // mapping never hit a full file system or block allocation
+  void Preallocate() const noexcept {
+    if (posix_fallocate(fd_, 0, size_) != 0)
+      LOG(WARNING) << "posix_fallocate failed, file stays sparse";
+  }
+
+  // Fault every page of the mapping in up front for writing
+  void Prefault() const noexcept {
+#ifdef MADV_POPULATE_WRITE
+    if (madvise(data_, size_, MADV_POPULATE_WRITE) == 0) return;
+#endif
+    // older kernels, an atomic add of zero write faults each page without
+    // racing with other processes writing to the same file
+    const size_t page_size = sysconf(_SC_PAGESIZE);
+    for (size_t offset = 0; offset < size_; offset += page_size)
+      __atomic_fetch_add(data_ + offset, 0, __ATOMIC_RELAXED);
+  }
+
+  // Write dirty pages back to the file, only needed to survive a machine
+  // crash, the page cache already outlives a process crash
+  void Sync() const noexcept { msync(data_, size_, MS_SYNC); }
+
+  char *Data() const noexcept { return data_; }
+
+  size_t Size() const noexcept { return size_; }
+
+  int Fd() const noexcept { return fd_; }
+
+  // Time spent in mlock and prefaulting by the last Open or Apply
+  std::chrono::nanoseconds PrefaultTime() const noexcept {
+    return prefault_time_;
+  }
+
+ private:
+  bool Map(const int fd, const size_t size, const bool reset,
+           const MMapOptions &options) noexcept {
+    fd_ = fd;
+
+    // size check and resize under an exclusive lock, a process racing us on
+    // a new file sees it sized and attaches instead of creating it again
+    CHECK(flock(fd_, LOCK_EX) == 0) << "Error locking fd: " << fd_;
+
+    struct stat stat_buf;
+    CHECK(fstat(fd_, &stat_buf) == 0) << "Error getting file size";
+
+    const bool create = reset || stat_buf.st_size == 0;
+    if (create) {
+      CHECK(ftruncate(fd_, size) != -1) << "Error resizing file";
+      size_ = size;
+    } else {
+      size_ = stat_buf.st_size;
+    }
+    flock(fd_, LOCK_UN);
+
+    data_ = static_cast<char *>(
+        mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0));
+    CHECK(data_ != MAP_FAILED) << "Error mapping fd: " << fd_;
+
+    Apply(options);
+    return create;
+  }
+
+  static int ToMadvise(const MMapOptions::Advice advice) noexcept {
+    switch (advice) {
+      case MMapOptions::Advice::SEQUENTIAL:
+        return MADV_SEQUENTIAL;
+      case MMapOptions::Advice::RANDOM:
+        return MADV_RANDOM;
+      case MMapOptions::Advice::HUGEPAGE:
+        return MADV_HUGEPAGE;
+      case MMapOptions::Advice::NONE:
+        break;
+    }
+    return MADV_NORMAL;
+  }
+
+ private:
+  int fd_{-1};
+  size_t size_{0};
+  char *data_{nullptr};
+
+  std::chrono::nanoseconds prefault_time_{0};
+};
+
+namespace detail {
+
+/**
+ * Fields every mmap backed container starts its file with, the container
+ * derives its own header from it
+ */
+struct MMapMeta {
+  // stored last with release, a process that sees it sees the whole header
+  std::atomic<uint64_t> magic;
+  uint32_t version;
+  // the data region holds capacity elements of elem_size bytes
+  uint32_t elem_size;
+  uint64_t capacity;
+};
+
+}  // namespace detail
+
+/**
+ * Writes and checks the detail::MMapMeta at the start of a mapped file. One
+ * process creates the header and publishes it, the others wait for it and
+ * validate it against what they expect
+ */
+class MMapHeader {
+ public:
+  static constexpr auto ATTACH_TIMEOUT = std::chrono::seconds(1);
+
+  // kind names the container in log messages, header_size is the size of
+  // its whole header
+  constexpr MMapHeader(const char *kind, const uint64_t magic,
+                       const uint32_t version, const uint32_t elem_size,
+                       const size_t header_size) noexcept
+      : kind_{kind},
+        magic_{magic},
+        version_{version},
+        elem_size_{elem_size},
+        header_size_{header_size} {}
+
+ public:
+  // Abort when file_size cannot hold the header and min_data_size bytes
+  void CheckFileSize(const size_t file_size,
+                     const size_t min_data_size) const noexcept {
+    CHECK(file_size >= header_size_ + min_data_size)
+        << "File size (" << file_size << " bytes) should fit the "
+        << kind_ << " header (" << header_size_ << " bytes) and at least "
+        << min_data_size << " bytes of data";
+  }
+
+  // Largest power of two count of slot_size byte slots after the header, so
+  // indices wrap with a mask
+  uint64_t MaskCapacity(const size_t file_size,
+                        const size_t slot_size) const noexcept {
+    auto capacity = (file_size - header_size_) / slot_size;
+    while (capacity & (capacity - 1)) capacity &= capacity - 1;
+    return capacity;
+  }
+
+  // Zero the header of file and fill in the shared fields, the container
+  // fills in its own ones before Publish
+  void Create(const MMapFile &file, const uint64_t capacity) const noexcept {
+    std::memset(file.Data(), 0, header_size_);
+    auto *meta = Meta(file);
+    meta->version = version_;
+    meta->elem_size = elem_size_;
+    meta->capacity = capacity;
+  }
+
+  // A concurrent attach sees either no magic or the whole header
+  void Publish(const MMapFile &file) const noexcept {
+    Meta(file)->magic.store(magic_, std::memory_order_release);
+  }
+
+  // Wait up to ATTACH_TIMEOUT for the creating process to publish the
+  // header of file, then check the shared fields and that the file holds
+  // data_size bytes of data, data_size computed from the published header
+  template <typename DataSize>
+  bool Validate(const MMapFile &file, const std::string &name,
+                const DataSize &data_size) const noexcept {
+    if (file.Size() < header_size_) {
+      LOG(ERROR) << "File at " << name << " is too small for a " << kind_;
+      return false;
+    }
+
+    const auto *meta = Meta(file);
+    const auto magic = WaitForMagic(meta);
+    if (magic == 0) {
+      LOG(ERROR) << "Timed out waiting for the " << kind_ << " header at "
+                 << name;
+      return false;
+    }
+
+    if (magic != magic_) {
+      LOG(ERROR) << "File at " << name << " is not a " << kind_;
+      return false;
+    }
+    if (meta->version != version_) {
+      LOG(ERROR) << "Unsupported " << kind_ << " version " << meta->version
+                 << ", expected " << version_;
+      return false;
+    }
+    if (meta->elem_size != elem_size_) {
+      LOG(ERROR) << "Element size mismatch, file has " << meta->elem_size
+                 << " bytes, expected " << elem_size_ << " bytes";
+      return false;
+    }
+    if (header_size_ + data_size() > file.Size()) {
+      LOG(ERROR) << "File at " << name << " is truncated";
+      return false;
+    }
+    return true;
+  }
+
+ private:
+  static detail::MMapMeta *Meta(const MMapFile &file) noexcept {
+    return reinterpret_cast<detail::MMapMeta *>(file.Data());
+  }
+
+  // the magic is stored last, 0 until the creating process is done
+  static uint64_t WaitForMagic(const detail::MMapMeta *meta) noexcept {
+    const auto deadline = std::chrono::steady_clock::now() + ATTACH_TIMEOUT;
+    auto magic = meta->magic.load(std::memory_order_acquire);
+    while (magic == 0 && std::chrono::steady_clock::now() < deadline) {
+      std::this_thread::sleep_for(std::chrono::microseconds(100));
+      magic = meta->magic.load(std::memory_order_acquire);
+    }
+    return magic;
+  }
+
+ private:
+  const char *kind_;
+  uint64_t magic_;
+  uint32_t version_;
+  uint32_t elem_size_;
+  size_t header_size_;
+};
+
+// Pass fd to the process at the other end of the unix domain socket
+inline bool SendFd(const int socket, const int fd) noexcept {
+  char byte = 0;
+  iovec iov{&byte, 1};
+
+  alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))] = {};
+  msghdr msg{};
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = control;
+  msg.msg_controllen = sizeof(control);
+
+  auto *cmsg = CMSG_FIRSTHDR(&msg);
+  cmsg->cmsg_level = SOL_SOCKET;
+  cmsg->cmsg_type = SCM_RIGHTS;
+  cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+  std::memcpy(CMSG_DATA(cmsg), &fd, sizeof(int));
+
+  return sendmsg(socket, &msg, 0) == 1;
+}
+
+// Receive a fd sent with SendFd, returns -1 on failure
+inline int ReceiveFd(const int socket) noexcept {
+  char byte;
+  iovec iov{&byte, 1};
+
+  alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))] = {};
+  msghdr msg{};
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = control;
+  msg.msg_controllen = sizeof(control);
+
+  if (recvmsg(socket, &msg, MSG_CMSG_CLOEXEC) != 1) return -1;
+
+  const auto *cmsg = CMSG_FIRSTHDR(&msg);
+  if (cmsg == nullptr || cmsg->cmsg_level != SOL_SOCKET ||
+      cmsg->cmsg_type != SCM_RIGHTS)
+    return -1;
+
+  int fd;
+  std::memcpy(&fd, CMSG_DATA(cmsg), sizeof(int));
+  return fd;
+}
+
+}  // namespace hermes::container
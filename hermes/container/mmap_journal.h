@@ -0,0 +1,350 @@
+#pragma once
+
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <span>
+#include <string>
+
+#include "hermes/container/mmap_file.h"
+
+namespace hermes::container {
+
+namespace detail {
+
+/**
+ * Layout of a journal file
+ *
+ *   line 0: MMapJournalMeta, written once when the file is created
+ *   line 1: committed byte offset into the record region
+ *   index : one offset + 1 per INDEX_STRIDE records, 0 means not written yet
+ *   data  : capacity bytes of [MMapJournalRecord][payload] records, 8 byte
+ *           aligned
+ */
+struct MMapJournalMeta : MMapMeta {
+  static constexpr uint64_t MAGIC = 0x4c4e524a53454d48;  // "HMESJRNL"
+  static constexpr uint32_t VERSION = 3;
+
+  uint32_t index_stride;
+  uint64_t index_entries;
+
+  // sequence number of the first record, segments of a rolling journal
+  // continue the sequence of the previous segment. Atomic as an empty
+  // journal is rebased while readers may have it mapped
+  std::atomic<uint64_t> first_seq;
+};
+
+struct MMapJournalRecord {
+  uint32_t size;
+  uint32_t reserved;
+  uint64_t seq;
+};
+
+}  // namespace detail
+
+/**
+ * Position of a reader in a journal
+ */
+struct JournalCursor {
+  uint64_t seq{0};
+  uint64_t offset{0};
+};
+
+/**
+ * Append-only memory mapped journal
+ *
+ * A single writer appends length prefixed records tagged with sequence
+ * numbers first_seq, first_seq + 1, ... Any number of readers, in this or
+ * other processes, replay from an arbitrary sequence number through views
+ * into the mapping.
+ * A sparse index of record offsets keeps seeking cheap. Reopening an
+ * existing journal with reset = false resumes appending after the last
+ * committed record
+ */
+class MMapJournal {
+  using Meta = detail::MMapJournalMeta;
+  using Record = detail::MMapJournalRecord;
+
+ public:
+  static constexpr uint32_t INDEX_STRIDE = 64;
+  static constexpr uint32_t RECORD_ALIGN = 8;
+
+ public:
+  MMapJournal(const MMapJournal &_) = delete;
+  MMapJournal &operator=(const MMapJournal &_) = delete;
+
+  MMapJournal() {}
+
+ public:
+  // Map the journal file at file_path. With reset the file is resized to
+  // file_size and the journal starts empty, otherwise an existing journal is
+  // reopened after its last record. Attaching waits up to
+  // MMapHeader::ATTACH_TIMEOUT for the creating process to publish the
+  // header. Returns false when it does not or when the header does not match
+  // this journal
+  bool Init(const std::string &file_path, const size_t file_size,
+            const bool reset, const uint64_t first_seq = 0) noexcept {
+    LOG(INFO) << "Initializing journal at path: " << file_path;
+
+    HEADER.CheckFileSize(file_size, sizeof(Record));
+
+    const bool create = file_.Open(file_path, file_size, reset);
+    return Attach(create, first_seq, file_path);
+  }
+
+  // Map an existing journal read-only for Seek, Poll and Replay, it is never
+  // created. Returns false when the file does not exist, e.g. a closed
+  // segment that was already removed, or when Init would fail to attach
+  bool InitReadOnly(const std::string &file_path) noexcept {
+    LOG(INFO) << "Initializing read-only journal at path: " << file_path;
+
+    if (!file_.OpenReadOnly(file_path)) {
+      LOG(WARNING) << "No journal at path: " << file_path;
+      return false;
+    }
+    return Attach(false, 0, file_path);
+  }
+
+  // Whether the header of the journal at file_path was ever written. A file
+  // that was created and sized but never got its header, e.g. a segment
+  // preallocated right before a crash, is empty or still has a zero magic
+  static bool IsHeaderWritten(const std::string &file_path) noexcept {
+    MMapFile file;
+    if (!file.OpenReadOnly(file_path) || file.Size() < HEADER_SIZE)
+      return false;
+
+    const auto *meta = reinterpret_cast<const Meta *>(file.Data());
+    return meta->magic.load(std::memory_order_acquire) != 0;
+  }
+
+  // Restart the sequence of an empty journal at first_seq
+  // Only the writer should call this method
+  void Rebase(const uint64_t first_seq) noexcept {
+    CHECK(BytesUsed() == 0) << "Only an empty journal can be rebased";
+    meta_->first_seq.store(first_seq, std::memory_order_release);
+    next_seq_ = first_seq;
+  }
+
+  // Reserve size bytes for the next record, the span is empty when the
+  // journal is full. Nothing is visible to readers until Commit
+  // Only the writer should call this method
+  std::span<char> Reserve(const uint32_t size) noexcept {
+    const auto offset = write_offset_->load(std::memory_order_relaxed);
+    if (offset + RecordSize(size) > data_capacity_) [[unlikely]]
+      return {};
+
+    return {data_ + offset + sizeof(Record), size};
+  }
+
+  // Publish the record returned by the last Reserve with its final size,
+  // returns its sequence number
+  // Only the writer should call this method
+  uint64_t Commit(const uint32_t size) noexcept {
+    const auto offset = write_offset_->load(std::memory_order_relaxed);
+    const auto seq = next_seq_;
+    const auto local_seq =
+        seq - meta_->first_seq.load(std::memory_order_relaxed);
+
+    auto *record = reinterpret_cast<Record *>(data_ + offset);
+    record->size = size;
+    record->reserved = 0;
+    record->seq = seq;
+
+    if (local_seq % INDEX_STRIDE == 0 &&
+        local_seq / INDEX_STRIDE < meta_->index_entries)
+      index_[local_seq / INDEX_STRIDE].store(offset + 1,
+                                             std::memory_order_relaxed);
+
+    next_seq_ += 1;
+    write_offset_->store(offset + RecordSize(size), std::memory_order_release);
+    return seq;
+  }
+
+  // Copy size bytes as one record, returns false when the journal is full
+  // Only the writer should call this method
+  bool Append(const void *data, const uint32_t size) noexcept {
+    auto buffer = Reserve(size);
+    if (buffer.data() == nullptr) return false;
+
+    std::memcpy(buffer.data(), data, size);
+    Commit(size);
+    return true;
+  }
+
+  // Cursor at record seq, at the first record when seq is older than the
+  // journal, or at the end when seq has not been written yet
+  JournalCursor Seek(const uint64_t seq) const noexcept {
+    const auto end = write_offset_->load(std::memory_order_acquire);
+    const auto first_seq = meta_->first_seq.load(std::memory_order_acquire);
+    const auto local_seq = seq > first_seq ? seq - first_seq : 0;
+
+    // closest indexed record at or before seq. Entries fill in order, so the
+    // ones committed before end form a prefix, binary search its last entry.
+    // Every record takes at least sizeof(Record) bytes, which bounds the
+    // search by the committed bytes for a seq past the end
+    auto low = uint64_t{0};
+    auto high = std::min({local_seq / INDEX_STRIDE, meta_->index_entries - 1,
+                          end / sizeof(Record) / INDEX_STRIDE});
+    while (low < high) {
+      const auto mid = low + (high - low + 1) / 2;
+      const auto offset = index_[mid].load(std::memory_order_relaxed);
+      if (offset != 0 && offset - 1 < end)
+        low = mid;
+      else
+        high = mid - 1;
+    }
+
+    JournalCursor cursor{first_seq, 0};
+    if (low > 0) {
+      cursor.seq = first_seq + low * INDEX_STRIDE;
+      cursor.offset = index_[low].load(std::memory_order_relaxed) - 1;
+    }
+
+    while (cursor.seq < seq && cursor.offset < end) Advance(cursor);
+    return cursor;
+  }
+
+  // Invoke functor(seq, payload) on every committed record from cursor and
+  // move cursor past them. Payloads are views into the mapping
+  template <typename Functor>
+  size_t Poll(JournalCursor &cursor, const Functor &functor) const {
+    const auto end = write_offset_->load(std::memory_order_acquire);
+
+    size_t count = 0;
+    while (cursor.offset < end) {
+      const auto *record = RecordAt(cursor.offset);
+      functor(record->seq, std::span<const char>{
+                               reinterpret_cast<const char *>(record + 1),
+                               record->size});
+      Advance(cursor);
+      count += 1;
+    }
+    return count;
+  }
+
+  // Invoke functor(seq, payload) on every committed record from from_seq
+  template <typename Functor>
+  size_t Replay(const uint64_t from_seq, const Functor &functor) const {
+    auto cursor = Seek(from_seq);
+    return Poll(cursor, functor);
+  }
+
+  uint64_t FirstSequence() const noexcept {
+    return meta_->first_seq.load(std::memory_order_acquire);
+  }
+
+  // Sequence number of the next appended record
+  uint64_t NextSequence() const noexcept { return next_seq_; }
+
+  size_t BytesUsed() const noexcept {
+    return write_offset_->load(std::memory_order_acquire);
+  }
+
+  size_t Capacity() const noexcept { return data_capacity_; }
+
+  // Whether a record of size bytes fits in an empty journal
+  bool Fits(const uint32_t size) const noexcept {
+    return RecordSize(size) <= data_capacity_;
+  }
+
+  void Sync() const noexcept { file_.Sync(); }
+
+  const MMapFile &File() const noexcept { return file_; }
+
+ private:
+  static constexpr uint64_t RecordSize(const uint32_t size) noexcept {
+    return (sizeof(Record) + size + RECORD_ALIGN - 1) & ~(RECORD_ALIGN - 1);
+  }
+
+  const Record *RecordAt(const uint64_t offset) const noexcept {
+    return reinterpret_cast<const Record *>(data_ + offset);
+  }
+
+  void Advance(JournalCursor &cursor) const noexcept {
+    cursor.offset += RecordSize(RecordAt(cursor.offset)->size);
+    cursor.seq += 1;
+  }
+
+  bool Attach(const bool create, const uint64_t first_seq,
+              const std::string &file_path) noexcept {
+    meta_ = reinterpret_cast<Meta *>(file_.Data());
+    write_offset_ =
+        reinterpret_cast<AtomicOffset *>(file_.Data() + CACHE_LINE);
+
+    if (create)
+      CreateHeader(first_seq);
+    else if (!ValidateHeader(file_path))
+      return false;
+
+    index_ = reinterpret_cast<AtomicOffset *>(file_.Data() + HEADER_SIZE);
+    data_ = reinterpret_cast<char *>(index_ + meta_->index_entries);
+    data_capacity_ = meta_->capacity;
+
+    // recover the next sequence number from the last committed record
+    next_seq_ = Seek(UINT64_MAX).seq;
+
+    LOG(INFO) << "Successfully initialized journal at path: " << file_path
+              << ", records = " << next_seq_ << ", bytes = " << BytesUsed();
+    return true;
+  }
+
+  void CreateHeader(const uint64_t first_seq) noexcept {
+    // every record takes at least sizeof(Record) bytes, size the index for
+    // the largest possible record count
+    const auto available = file_.Size() - HEADER_SIZE;
+    const auto index_entries =
+        available / (INDEX_STRIDE * sizeof(Record) + sizeof(uint64_t)) + 1;
+
+    HEADER.Create(file_, available - index_entries * sizeof(uint64_t));
+    meta_->index_stride = INDEX_STRIDE;
+    meta_->index_entries = index_entries;
+    meta_->first_seq.store(first_seq, std::memory_order_relaxed);
+
+    new (write_offset_) AtomicOffset{0};
+    std::memset(file_.Data() + HEADER_SIZE, 0,
+                index_entries * sizeof(uint64_t));
+
+    HEADER.Publish(file_);
+  }
+
+  bool ValidateHeader(const std::string &file_path) noexcept {
+    if (!HEADER.Validate(file_, file_path, [&] {
+          return meta_->index_entries * sizeof(uint64_t) + meta_->capacity;
+        }))
+      return false;
+
+    if (meta_->index_stride != INDEX_STRIDE) {
+      LOG(ERROR) << "Journal index stride mismatch, file has "
+                 << meta_->index_stride << ", expected " << INDEX_STRIDE;
+      return false;
+    }
+    return true;
+  }
+
+ private:
+  static constexpr size_t CACHE_LINE = 64;
+  static constexpr size_t HEADER_SIZE = 2 * CACHE_LINE;
+  // the data region is counted in bytes
+  static constexpr MMapHeader HEADER{"journal", Meta::MAGIC, Meta::VERSION, 1,
+                                     HEADER_SIZE};
+
+  using AtomicOffset = std::atomic<uint64_t>;
+  static_assert(AtomicOffset::is_always_lock_free,
+                "shared memory offsets must be lock free");
+
+ private:
+  MMapFile file_;
+
+  Meta *meta_{nullptr};
+  AtomicOffset *write_offset_{nullptr};
+  AtomicOffset *index_{nullptr};
+  char *data_{nullptr};
+  uint64_t data_capacity_{0};
+
+  // writer local
+  uint64_t next_seq_{0};
+};
+
+}  // namespace hermes::container
@@ -0,0 +1,145 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <new>
+#include <optional>
+#include <type_traits>
+
+#include "hermes/container/sequenced_slot.h"
+
+namespace hermes::container {
+
+/**
+ * Bounded Multi Producer Multi Consumer Queue
+ *
+ * Vyukov style ring, producers and consumers each claim positions with a CAS
+ * on their own padded index and hand slots to each other through the per
+ * slot sequence number. MAX_SIZE must be a power of two
+ */
+template <typename T, uint32_t MAX_SIZE>
+class MpmcQueue {
+  static_assert(MAX_SIZE >= 2 && (MAX_SIZE & (MAX_SIZE - 1)) == 0,
+                "MpmcQueue capacity must be a power of two");
+
+  using Slot = detail::SequencedSlot<T>;
+
+ public:
+  MpmcQueue(const MpmcQueue &_) = delete;
+  MpmcQueue &operator=(const MpmcQueue &_) = delete;
+
+  MpmcQueue() {
+    slots_ = detail::NewSequencedSlots<T>(MAX_SIZE);
+
+    write_index_ = 0;
+    read_index_ = 0;
+  }
+
+  ~MpmcQueue() {
+    while (ConsumeOne([](T &) {})) {
+    }
+    detail::DeleteSequencedSlots(slots_);
+  }
+
+ public:
+  // Emplace value at the begin of the queue
+  // Any producer thread can call this method
+  template <typename... Args>
+  bool Write(Args &&...args) {
+    return detail::SequencedWrite(slots_, MASK, write_index_,
+                                  std::forward<Args>(args)...);
+  }
+
+  // Read the last value from the queue
+  // Any consumer thread can call this method
+  bool Read(T &record) {
+    return ConsumeOne([&](T &value) {
+      if constexpr (std::is_move_assignable<T>::value)
+        record = std::move(value);
+      else
+        record = value;
+    });
+  }
+
+  std::optional<T> Read() {
+    std::optional<T> ret;
+    ConsumeOne([&](T &value) { ret.emplace(std::move(value)); });
+    return ret;
+  }
+
+  // Claim the front value, invoke functor on it in place, then destroy it
+  // Any consumer thread can call this method
+  template <typename Functor>
+  bool ConsumeOne(const Functor &functor) {
+    auto pos = read_index_.load(std::memory_order_relaxed);
+
+    while (true) {
+      auto &slot = slots_[pos & MASK];
+      const auto seq = slot.seq.load(std::memory_order_acquire);
+      const auto diff = static_cast<int64_t>(seq - (pos + 1));
+
+      if (diff == 0) {
+        if (read_index_.compare_exchange_weak(pos, pos + 1,
+                                              std::memory_order_relaxed))
+          [[likely]] {
+          auto *value = slot.Value();
+          functor(*value);
+          value->~T();
+
+          // hand the slot to the producers of the next lap
+          slot.seq.store(pos + MAX_SIZE, std::memory_order_release);
+          return true;
+        }
+        // lost the race, pos was reloaded by the CAS
+      } else if (diff < 0) {
+        // queue is empty
+        return false;
+      } else {
+        pos = read_index_.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  // Consume values one by one until the queue looks empty. Other consumers
+  // may interleave, so the values are not guaranteed to be contiguous
+  template <typename Functor>
+  size_t ConsumeAll(const Functor &functor) {
+    size_t count = 0;
+    while (ConsumeOne(functor)) count += 1;
+    return count;
+  }
+
+  bool IsEmpty() const noexcept { return SizeGuess() == 0; }
+
+  size_t SizeGuess() const noexcept {
+    const auto curr_read = read_index_.load(std::memory_order_acquire);
+    const auto curr_write = write_index_.load(std::memory_order_acquire);
+    return curr_write > curr_read ? curr_write - curr_read : 0;
+  }
+
+  static constexpr uint32_t Capacity() noexcept { return MAX_SIZE; }
+
+ private:
+  static constexpr uint64_t MASK = MAX_SIZE - 1;
+
+  using AtomicIndex = std::atomic<uint64_t>;
+  static constexpr std::size_t CACHE_LINE_SIZE =
+#ifdef __cpp_lib_hardware_interference_size
+      std::hardware_destructive_interference_size;
+#else
+      64;
+#endif
+
+ private:
+  Slot *slots_;
+
+  // shared by all producers
+  alignas(CACHE_LINE_SIZE) AtomicIndex write_index_;
+
+  // shared by all consumers
+  alignas(CACHE_LINE_SIZE) AtomicIndex read_index_;
+
+  char pad_0_[CACHE_LINE_SIZE - sizeof(AtomicIndex)];
+};
+
+}  // namespace hermes::container
@@ -0,0 +1,152 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <new>
+#include <optional>
+#include <type_traits>
+
+#include "hermes/container/sequenced_slot.h"
+
+namespace hermes::container {
+
+/**
+ * Bounded Multi Producer Single Consumer Queue
+ *
+ * Producers claim positions with a CAS on write_index_ and publish through
+ * the per slot sequence number, so a slow producer never exposes a half
+ * written value. MAX_SIZE must be a power of two
+ */
+template <typename T, uint32_t MAX_SIZE>
+class MpscQueue {
+  static_assert(MAX_SIZE >= 2 && (MAX_SIZE & (MAX_SIZE - 1)) == 0,
+                "MpscQueue capacity must be a power of two");
+
+  using Slot = detail::SequencedSlot<T>;
+
+ public:
+  MpscQueue(const MpscQueue &_) = delete;
+  MpscQueue &operator=(const MpscQueue &_) = delete;
+
+  MpscQueue() {
+    slots_ = detail::NewSequencedSlots<T>(MAX_SIZE);
+
+    write_index_ = 0;
+    read_index_ = 0;
+  }
+
+  ~MpscQueue() {
+    while (ConsumeOne([](T &) {})) {
+    }
+    detail::DeleteSequencedSlots(slots_);
+  }
+
+ public:
+  // Emplace value at the begin of the queue
+  // Any producer thread can call this method
+  template <typename... Args>
+  bool Write(Args &&...args) {
+    return detail::SequencedWrite(slots_, MASK, write_index_,
+                                  std::forward<Args>(args)...);
+  }
+
+  // Read the last value from the queue
+  // Only consumer thread should call this method
+  bool Read(T &record) {
+    return ConsumeOne([&](T &value) {
+      if constexpr (std::is_move_assignable<T>::value)
+        record = std::move(value);
+      else
+        record = value;
+    });
+  }
+
+  std::optional<T> Read() {
+    std::optional<T> ret;
+    ConsumeOne([&](T &value) { ret.emplace(std::move(value)); });
+    return ret;
+  }
+
+  // Invoke functor on the front value in place, then destroy it
+  // Only consumer thread should call this method
+  template <typename Functor>
+  bool ConsumeOne(const Functor &functor) {
+    const auto pos = read_index_.load(std::memory_order_relaxed);
+    auto &slot = slots_[pos & MASK];
+
+    if (slot.seq.load(std::memory_order_acquire) != pos + 1) return false;
+
+    ConsumeSlot(slot, pos, functor);
+    read_index_.store(pos + 1, std::memory_order_relaxed);
+    return true;
+  }
+
+  // Invoke functor in place on every value claimed at call time, stops early
+  // at the first slot whose producer has not finished writing. Values claimed
+  // during the call are left for the next one, so it returns under a steady
+  // stream of producers
+  // Only consumer thread should call this method
+  template <typename Functor>
+  size_t ConsumeAll(const Functor &functor) {
+    auto pos = read_index_.load(std::memory_order_relaxed);
+    const auto curr_write = write_index_.load(std::memory_order_acquire);
+    const auto start = pos;
+
+    while (pos < curr_write) {
+      auto &slot = slots_[pos & MASK];
+      if (slot.seq.load(std::memory_order_acquire) != pos + 1) break;
+
+      ConsumeSlot(slot, pos, functor);
+      pos += 1;
+    }
+
+    if (pos != start) read_index_.store(pos, std::memory_order_relaxed);
+    return pos - start;
+  }
+
+  bool IsEmpty() const noexcept { return SizeGuess() == 0; }
+
+  size_t SizeGuess() const noexcept {
+    const auto curr_read = read_index_.load(std::memory_order_acquire);
+    const auto curr_write = write_index_.load(std::memory_order_acquire);
+    return curr_write > curr_read ? curr_write - curr_read : 0;
+  }
+
+  static constexpr uint32_t Capacity() noexcept { return MAX_SIZE; }
+
+ private:
+  template <typename Functor>
+  static void ConsumeSlot(Slot &slot, const uint64_t pos,
+                          const Functor &functor) {
+    auto *value = slot.Value();
+    functor(*value);
+    value->~T();
+
+    // hand the slot to the producers of the next lap
+    slot.seq.store(pos + MAX_SIZE, std::memory_order_release);
+  }
+
+ private:
+  static constexpr uint64_t MASK = MAX_SIZE - 1;
+
+  using AtomicIndex = std::atomic<uint64_t>;
+  static constexpr std::size_t CACHE_LINE_SIZE =
+#ifdef __cpp_lib_hardware_interference_size
+      std::hardware_destructive_interference_size;
+#else
+      64;
+#endif
+
+ private:
+  Slot *slots_;
+
+  // shared by all producers
+  alignas(CACHE_LINE_SIZE) AtomicIndex write_index_;
+
+  // consumer owned cache line
+  alignas(CACHE_LINE_SIZE) AtomicIndex read_index_;
+
+  char pad_0_[CACHE_LINE_SIZE - sizeof(AtomicIndex)];
+};
+
+}  // namespace hermes::container
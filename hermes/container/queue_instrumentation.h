@@ -0,0 +1,146 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <new>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace hermes::container {
+
+/**
+ * Queue instrumentation policies, selected at compile time through the queue
+ * template. Every policy exposes ENABLED, the queue only calls into policies
+ * with ENABLED = true, so a disabled policy adds no code and no state
+ */
+
+inline uint64_t ReadTsc() noexcept {
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  return std::chrono::steady_clock::now().time_since_epoch().count();
+#endif
+}
+
+/**
+ * Power of two histogram, bucket i counts samples in [2^(i-1), 2^i).
+ * Single writer, readable from any thread without locking
+ */
+class LatencyHistogram {
+ public:
+  static constexpr uint32_t BUCKETS = 64;
+
+ public:
+  void Record(const uint64_t value) noexcept {
+    auto &bucket = buckets_[Bucket(value)];
+    bucket.store(bucket.load(std::memory_order_relaxed) + 1,
+                 std::memory_order_relaxed);
+  }
+
+  uint64_t Count(const uint32_t bucket) const noexcept {
+    return buckets_[bucket].load(std::memory_order_relaxed);
+  }
+
+  uint64_t TotalCount() const noexcept {
+    uint64_t ret = 0;
+    for (uint32_t i = 0; i < BUCKETS; ++i) ret += Count(i);
+    return ret;
+  }
+
+  // Upper bound of the bucket holding the p-th percentile, p in [0, 1]
+  uint64_t Percentile(const double p) const noexcept {
+    const auto total = TotalCount();
+    if (!total) return 0;
+
+    const auto target = static_cast<uint64_t>(p * (total - 1)) + 1;
+    uint64_t seen = 0;
+    for (uint32_t i = 0; i < BUCKETS; ++i) {
+      seen += Count(i);
+      if (seen >= target) return BucketUpperBound(i);
+    }
+    return BucketUpperBound(BUCKETS - 1);
+  }
+
+  static constexpr uint32_t Bucket(const uint64_t value) noexcept {
+    const auto width = 64 - __builtin_clzll(value | 1);
+    return value ? std::min<uint32_t>(width, BUCKETS - 1) : 0;
+  }
+
+  static constexpr uint64_t BucketUpperBound(const uint32_t bucket) noexcept {
+    return bucket ? (uint64_t{1} << bucket) - 1 : 0;
+  }
+
+ private:
+  std::atomic<uint64_t> buckets_[BUCKETS]{};
+};
+
+/**
+ * No instrumentation, the queue compiles to its uninstrumented code
+ */
+struct NoQueueInstrumentation {
+  static constexpr bool ENABLED = false;
+};
+
+/**
+ * Stamps every slot with the TSC at write time and records the time the
+ * value spent in the queue when it is read, together with the occupancy high
+ * water mark seen by the producer. Producer and consumer state live on
+ * separate cache lines
+ */
+class TscQueueInstrumentation {
+ public:
+  static constexpr bool ENABLED = true;
+
+ public:
+  void Init(const size_t slots) {
+    stamps_ = std::make_unique<uint64_t[]>(slots);
+  }
+
+  // Producer side, n contiguous slots starting at slot were written and the
+  // queue now holds occupancy values
+  void OnWrite(const size_t slot, const uint32_t n,
+               const uint64_t occupancy) noexcept {
+    const auto now = ReadTsc();
+    for (uint32_t i = 0; i < n; ++i) stamps_[slot + i] = now;
+
+    if (occupancy > high_water_mark_.load(std::memory_order_relaxed))
+      high_water_mark_.store(occupancy, std::memory_order_relaxed);
+  }
+
+  // Consumer side, the value in slot was read
+  void OnRead(const size_t slot) noexcept {
+    residency_.Record(ReadTsc() - stamps_[slot]);
+  }
+
+  // Residency time in TSC ticks
+  const LatencyHistogram &Residency() const noexcept { return residency_; }
+
+  // Highest occupancy seen by the producer
+  uint64_t HighWaterMark() const noexcept {
+    return high_water_mark_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  static constexpr std::size_t CACHE_LINE_SIZE =
+#ifdef __cpp_lib_hardware_interference_size
+      std::hardware_destructive_interference_size;
+#else
+      64;
+#endif
+
+ private:
+  std::unique_ptr<uint64_t[]> stamps_;
+
+  // producer owned cache line
+  alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> high_water_mark_{0};
+
+  // consumer owned cache lines
+  alignas(CACHE_LINE_SIZE) LatencyHistogram residency_;
+};
+
+}  // namespace hermes::container
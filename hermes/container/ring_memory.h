@@ -0,0 +1,135 @@
+#pragma once
+
+#include <glog/logging.h>
+#include <linux/mempolicy.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+namespace hermes::container {
+
+/**
+ * Backing storage options for ring buffers
+ */
+struct RingMemoryOptions {
+  // Back the ring with 2 MB pages, MAP_HUGETLB first then transparent huge
+  // pages through madvise when no hugetlbfs pages are reserved
+  bool huge_pages{false};
+
+  // Touch every page at construction so the hot path never page faults
+  bool prefault{false};
+
+  // Bind the pages to this NUMA node, -1 leaves placement to the kernel
+  int numa_node{-1};
+
+  // NUMA node of the calling thread, construct the options from the consumer
+  // thread to keep the ring local to it
+  static int CurrentNumaNode() noexcept {
+    unsigned cpu = 0, node = 0;
+    if (syscall(SYS_getcpu, &cpu, &node, nullptr) != 0) return -1;
+    return static_cast<int>(node);
+  }
+};
+
+/**
+ * Raw memory for a ring buffer. Default options allocate with operator new
+ * exactly like a plain array, any other option maps anonymous memory
+ */
+class RingMemory {
+ public:
+  static constexpr size_t HUGE_PAGE_SIZE = 2 << 20;
+
+ public:
+  RingMemory(const RingMemory &_) = delete;
+  RingMemory &operator=(const RingMemory &_) = delete;
+
+  RingMemory(const size_t bytes, const RingMemoryOptions &options) {
+    if (!options.huge_pages && !options.prefault && options.numa_node < 0) {
+      data_ = operator new[](bytes);
+      return;
+    }
+
+    Map(bytes, options);
+    if (options.numa_node >= 0) Bind(options.numa_node);
+    if (options.prefault) Prefault();
+  }
+
+  ~RingMemory() noexcept {
+    if (mapped_size_)
+      munmap(data_, mapped_size_);
+    else
+      operator delete[](data_);
+  }
+
+ public:
+  void *Data() const noexcept { return data_; }
+
+  bool IsMapped() const noexcept { return mapped_size_ != 0; }
+
+  bool IsHugeTlb() const noexcept { return huge_tlb_; }
+
+ private:
+  void Map(const size_t bytes, const RingMemoryOptions &options) {
+    const size_t page_size = sysconf(_SC_PAGESIZE);
+    const size_t align = options.huge_pages ? HUGE_PAGE_SIZE : page_size;
+    mapped_size_ = (bytes + align - 1) / align * align;
+
+    constexpr int FLAGS = MAP_PRIVATE | MAP_ANONYMOUS;
+    void *addr = MAP_FAILED;
+
+    if (options.huge_pages) {
+      addr = mmap(nullptr, mapped_size_, PROT_READ | PROT_WRITE,
+                  FLAGS | MAP_HUGETLB, -1, 0);
+      huge_tlb_ = addr != MAP_FAILED;
+      LOG_IF(WARNING, !huge_tlb_)
+          << "MAP_HUGETLB failed for " << mapped_size_
+          << " bytes, falling back to transparent huge pages";
+    }
+
+    if (addr == MAP_FAILED) {
+      addr = mmap(nullptr, mapped_size_, PROT_READ | PROT_WRITE, FLAGS, -1, 0);
+      if (addr == MAP_FAILED) throw std::bad_alloc{};
+
+      if (options.huge_pages && madvise(addr, mapped_size_, MADV_HUGEPAGE))
+        LOG(WARNING) << "madvise(MADV_HUGEPAGE) failed, using normal pages";
+    }
+
+    data_ = addr;
+  }
+
+  void Bind(const int node) noexcept {
+    constexpr size_t MAX_NODES = 1024;
+    constexpr size_t BITS = 8 * sizeof(unsigned long);
+    if (size_t(node) >= MAX_NODES) {
+      LOG(WARNING) << "NUMA node " << node << " out of range, not binding";
+      return;
+    }
+
+    unsigned long node_mask[MAX_NODES / BITS] = {};
+    node_mask[node / BITS] = 1UL << (node % BITS);
+
+    // must run before the pages are faulted in, MPOL_MF_MOVE covers pages
+    // that were already touched
+    if (syscall(SYS_mbind, data_, mapped_size_, MPOL_BIND, node_mask,
+                MAX_NODES + 1, MPOL_MF_MOVE) != 0)
+      LOG(WARNING) << "mbind to NUMA node " << node << " failed";
+  }
+
+  void Prefault() noexcept {
+    const size_t page_size = sysconf(_SC_PAGESIZE);
+    auto *ptr = static_cast<volatile char *>(data_);
+    for (size_t offset = 0; offset < mapped_size_; offset += page_size)
+      ptr[offset] = 0;
+  }
+
+ private:
+  void *data_{nullptr};
+  size_t mapped_size_{0};
+  bool huge_tlb_{false};
+};
+
+}  // namespace hermes::container
@@ -0,0 +1,353 @@
+#pragma once
+
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <cinttypes>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "hermes/container/mmap_journal.h"
+
+namespace hermes::container {
+
+struct SegmentedJournalOptions {
+  // Size of every segment file in bytes
+  size_t segment_size{1 << 30};
+
+  // Keep closed segments on disk for Replay, the hook below may still move
+  // or compress them
+  bool retain_segments{true};
+
+  // Called on the background thread once a closed segment is unmapped, for
+  // example to compress or archive it
+  std::function<void(const std::string &)> on_segment_closed;
+};
+
+/**
+ * Append-only journal split over segment files prefix.000000, prefix.000001,
+ * ... Each segment is an MMapJournal continuing the sequence of the previous
+ * one. A background thread preallocates and prefaults the next segment ahead
+ * of time and unmaps closed segments, so rolling over only swaps pointers on
+ * the writer thread.
+ *
+ * Other processes replay a segment by opening its file with MMapJournal
+ */
+class SegmentedJournal {
+ public:
+  SegmentedJournal(const SegmentedJournal &_) = delete;
+  SegmentedJournal &operator=(const SegmentedJournal &_) = delete;
+
+  SegmentedJournal() {}
+
+  ~SegmentedJournal() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+    }
+    cv_.notify_one();
+    if (worker_.joinable()) worker_.join();
+
+    // background thread is gone, close what it left behind
+    for (auto &closed : closing_) CloseSegment(std::move(closed));
+    closing_.clear();
+  }
+
+ public:
+  // Open the segments at prefix, resuming in the last segment holding
+  // records unless reset is set, in which case old segment files are
+  // removed. Older segments may be gone, removed or moved once closed, the
+  // sequence resumes from the segments that are left
+  void Init(const std::string &prefix,
+            const SegmentedJournalOptions &options, const bool reset) {
+    LOG(INFO) << "Initializing segmented journal at prefix: " << prefix;
+
+    prefix_ = prefix;
+    options_ = options;
+
+    auto indices = ExistingSegments();
+    if (reset) {
+      for (const auto index : indices)
+        std::filesystem::remove(SegmentPath(index));
+      indices.clear();
+    }
+
+    if (indices.empty()) {
+      current_ = OpenSegment(0, true);
+      current_index_ = 0;
+    } else {
+      // the writer resumes in the last segment holding records. Empty files
+      // after it are segments preallocated by an earlier run, possibly
+      // without a header if it crashed, the next one is preallocated again
+      // in place and the others are removed
+      size_t current = indices.size() - 1;
+      while (current > 0 && IsEmptySegment(indices[current])) current -= 1;
+      current_index_ = indices[current];
+
+      for (size_t i = current + 1; i < indices.size(); ++i) {
+        if (indices[i] == current_index_ + 1) continue;
+        LOG(WARNING) << "Removing stale preallocated segment "
+                     << SegmentPath(indices[i]);
+        std::filesystem::remove(SegmentPath(indices[i]));
+      }
+
+      // segments before the current one go through the same close path as
+      // rolled segments, a crash may have left them unclosed
+      for (size_t i = 0; i < current; ++i) {
+        const auto path = SegmentPath(indices[i]);
+        auto closed = std::make_unique<MMapJournal>();
+        CHECK(closed->InitReadOnly(path))
+            << "Segment " << path << " disappeared on startup";
+        segments_.push_back({path, closed->FirstSequence()});
+        closing_.push_back({std::move(closed), path});
+      }
+
+      current_ = OpenSegment(current_index_,
+                             !MMapJournal::IsHeaderWritten(
+                                 SegmentPath(current_index_)));
+    }
+    segments_.push_back(
+        {SegmentPath(current_index_), current_->FirstSequence()});
+
+    worker_ = std::thread([this]() { BackgroundLoop(); });
+    RequestPreallocation();
+
+    LOG(INFO) << "Successfully initialized segmented journal at prefix: "
+              << prefix << ", segments = " << segments_.size()
+              << ", next sequence = " << NextSequence();
+  }
+
+  // Reserve size bytes for the next record, rolling to a new segment when
+  // the current one is full. The span is empty when size does not fit in an
+  // empty segment, such a record is rejected without rolling
+  // Only the writer should call this method
+  std::span<char> Reserve(const uint32_t size) {
+    if (!current_->Fits(size)) [[unlikely]] {
+      LOG(ERROR) << "Record of " << size
+                 << " bytes is larger than a journal segment of "
+                 << options_.segment_size << " bytes";
+      return {};
+    }
+
+    auto buffer = current_->Reserve(size);
+    if (buffer.data() == nullptr && current_->BytesUsed() != 0) {
+      Roll();
+      buffer = current_->Reserve(size);
+    }
+    return buffer;
+  }
+
+  // Only the writer should call this method
+  uint64_t Commit(const uint32_t size) noexcept {
+    return current_->Commit(size);
+  }
+
+  // Only the writer should call this method
+  bool Append(const void *data, const uint32_t size) {
+    auto buffer = Reserve(size);
+    if (buffer.data() == nullptr) return false;
+
+    std::memcpy(buffer.data(), data, size);
+    Commit(size);
+    return true;
+  }
+
+  // Invoke functor(seq, payload) on every record from from_seq across all
+  // retained segments
+  // Only the writer thread should call this method
+  template <typename Functor>
+  size_t Replay(const uint64_t from_seq, const Functor &functor) const {
+    size_t count = 0;
+    for (size_t i = 0; i + 1 < segments_.size(); ++i) {
+      // segment ends before from_seq
+      if (segments_[i + 1].first_seq <= from_seq) continue;
+
+      // read-only and never created, the background thread may remove a
+      // closed segment at any time, an open mapping outlives the removal
+      const auto &path = segments_[i].path;
+      MMapJournal closed;
+      if (!closed.InitReadOnly(path)) {
+        LOG(WARNING) << "Segment " << path << " is gone, skipping it";
+        continue;
+      }
+      count += closed.Replay(from_seq, functor);
+    }
+    return count + current_->Replay(from_seq, functor);
+  }
+
+  uint64_t NextSequence() const noexcept { return current_->NextSequence(); }
+
+  size_t SegmentCount() const noexcept { return segments_.size(); }
+
+  std::string SegmentPath(const uint64_t index) const {
+    char suffix[24];
+    std::snprintf(suffix, sizeof(suffix), ".%06" PRIu64, index);
+    return prefix_ + suffix;
+  }
+
+ private:
+  struct Segment {
+    std::string path;
+    uint64_t first_seq;
+  };
+
+  struct ClosingSegment {
+    std::unique_ptr<MMapJournal> journal;
+    std::string path;
+  };
+
+  // Sorted indices of the segment files at prefix_
+  std::vector<uint64_t> ExistingSegments() const {
+    const std::filesystem::path prefix{prefix_};
+    auto dir = prefix.parent_path();
+    if (dir.empty()) dir = ".";
+    const auto stem = prefix.filename().string() + ".";
+
+    std::vector<uint64_t> indices;
+    std::error_code error;
+    for (const auto &entry : std::filesystem::directory_iterator(dir, error)) {
+      const auto name = entry.path().filename().string();
+      if (name.size() <= stem.size() || name.compare(0, stem.size(), stem))
+        continue;
+
+      const auto suffix = name.substr(stem.size());
+      if (!std::all_of(suffix.begin(), suffix.end(),
+                       [](const char c) { return c >= '0' && c <= '9'; }))
+        continue;
+      indices.push_back(std::stoull(suffix));
+    }
+
+    std::sort(indices.begin(), indices.end());
+    return indices;
+  }
+
+  // Whether the segment file at index never got a record
+  bool IsEmptySegment(const uint64_t index) const {
+    const auto path = SegmentPath(index);
+    if (!MMapJournal::IsHeaderWritten(path)) return true;
+
+    MMapJournal segment;
+    CHECK(segment.InitReadOnly(path)) << "Error opening segment " << path;
+    return segment.BytesUsed() == 0;
+  }
+
+  std::unique_ptr<MMapJournal> OpenSegment(const uint64_t index,
+                                           const bool reset) const {
+    auto journal = std::make_unique<MMapJournal>();
+    CHECK(journal->Init(SegmentPath(index), options_.segment_size, reset))
+        << "Error opening journal segment " << SegmentPath(index);
+    return journal;
+  }
+
+  // Swap in the preallocated segment and hand the full one to the
+  // background thread
+  void Roll() {
+    std::unique_ptr<MMapJournal> next;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      if (!ready_) [[unlikely]] {
+        // the background thread is already creating it
+        LOG(WARNING) << "Next journal segment is not preallocated yet, "
+                     << "waiting for it on the writer thread";
+        ready_cv_.wait(lock, [this]() { return ready_ != nullptr; });
+      }
+      next = std::move(ready_);
+    }
+
+    next->Rebase(current_->NextSequence());
+    current_index_ += 1;
+    segments_.push_back(
+        {SegmentPath(current_index_), current_->NextSequence()});
+
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      closing_.push_back(
+          {std::move(current_), SegmentPath(current_index_ - 1)});
+      preallocate_index_ = current_index_ + 1;
+    }
+    current_ = std::move(next);
+    cv_.notify_one();
+  }
+
+  void RequestPreallocation() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      preallocate_index_ = current_index_ + 1;
+    }
+    cv_.notify_one();
+  }
+
+  void BackgroundLoop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+      cv_.wait(lock, [this]() {
+        return stop_ || !closing_.empty() || preallocate_index_ != 0;
+      });
+      if (stop_) return;
+
+      if (!closing_.empty()) {
+        auto closed = std::move(closing_.front());
+        closing_.pop_front();
+
+        lock.unlock();
+        CloseSegment(std::move(closed));
+        lock.lock();
+      }
+
+      if (preallocate_index_ != 0) {
+        const auto index = preallocate_index_;
+        preallocate_index_ = 0;
+
+        lock.unlock();
+        auto journal = OpenSegment(index, true);
+        journal->File().Preallocate();
+        journal->File().Prefault();
+        lock.lock();
+
+        ready_ = std::move(journal);
+        ready_cv_.notify_one();
+      }
+    }
+  }
+
+  void CloseSegment(ClosingSegment closed) {
+    // unmapping a large segment is slow, keep it off the writer thread
+    closed.journal.reset();
+
+    if (!options_.retain_segments)
+      std::filesystem::remove(closed.path);
+    else if (options_.on_segment_closed)
+      options_.on_segment_closed(closed.path);
+  }
+
+ private:
+  std::string prefix_;
+  SegmentedJournalOptions options_;
+
+  // writer thread state
+  std::unique_ptr<MMapJournal> current_;
+  uint64_t current_index_{0};
+  std::vector<Segment> segments_;
+
+  // shared with the background thread, guarded by mutex_
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::condition_variable ready_cv_;
+  std::unique_ptr<MMapJournal> ready_;
+  std::deque<ClosingSegment> closing_;
+  uint64_t preallocate_index_{0};
+  bool stop_{false};
+
+  std::thread worker_;
+};
+
+}  // namespace hermes::container
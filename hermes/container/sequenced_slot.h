@@ -0,0 +1,77 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <new>
+#include <utility>
+
+namespace hermes::container {
+
+namespace detail {
+
+/**
+ * Ring slot guarded by its own sequence number. For a slot at position pos
+ *   seq == pos                  -> free, a producer may claim it
+ *   seq == pos + 1              -> holds a value for the consumer
+ *   seq == pos + CAPACITY       -> freed for the next lap of the ring
+ */
+template <typename T>
+struct SequencedSlot {
+  std::atomic<uint64_t> seq;
+  alignas(T) unsigned char storage[sizeof(T)];
+
+  T *Value() noexcept { return std::launder(reinterpret_cast<T *>(storage)); }
+};
+
+// Slots of a ring of count positions, each free for the first lap. Aligned
+// for over-aligned T, release them with DeleteSequencedSlots
+template <typename T>
+SequencedSlot<T> *NewSequencedSlots(const uint32_t count) {
+  auto *slots = static_cast<SequencedSlot<T> *>(
+      operator new[](sizeof(SequencedSlot<T>) * count,
+                     std::align_val_t{alignof(SequencedSlot<T>)}));
+  for (uint32_t i = 0; i < count; ++i)
+    new (&slots[i].seq) std::atomic<uint64_t>{i};
+  return slots;
+}
+
+template <typename T>
+void DeleteSequencedSlots(SequencedSlot<T> *slots) noexcept {
+  operator delete[](slots, std::align_val_t{alignof(SequencedSlot<T>)});
+}
+
+// Producer side of a Vyukov ring, shared by every multi producer queue.
+// Claims the next position with a CAS on write_index once its slot is free
+// for this lap, emplaces the value and publishes it as seq == pos + 1.
+// Returns false when the ring is full
+template <typename T, typename... Args>
+bool SequencedWrite(SequencedSlot<T> *slots, const uint64_t mask,
+                    std::atomic<uint64_t> &write_index, Args &&...args) {
+  auto pos = write_index.load(std::memory_order_relaxed);
+
+  while (true) {
+    auto &slot = slots[pos & mask];
+    const auto seq = slot.seq.load(std::memory_order_acquire);
+    const auto diff = static_cast<int64_t>(seq - pos);
+
+    if (diff == 0) {
+      if (write_index.compare_exchange_weak(pos, pos + 1,
+                                            std::memory_order_relaxed))
+        [[likely]] {
+        new (slot.storage) T{std::forward<Args>(args)...};
+        slot.seq.store(pos + 1, std::memory_order_release);
+        return true;
+      }
+      // lost the race, pos was reloaded by the CAS
+    } else if (diff < 0) {
+      // queue is full
+      return false;
+    } else {
+      pos = write_index.load(std::memory_order_relaxed);
+    }
+  }
+}
+
+}  // namespace detail
+
+}  // namespace hermes::container
@@ -0,0 +1,234 @@
+#pragma once
+
+#include <atomic>
+#include <cstring>
+#include <new>
+#include <span>
+
+namespace hermes::container {
+
+/**
+ * Single Producer Single Consumer ring of variable size byte records
+ *
+ * Records are stored contiguously as [uint64 length][payload], rounded up to
+ * RECORD_ALIGN bytes, so every payload starts RECORD_ALIGN aligned. A record
+ * never straddles the end of the ring, when it does not fit the producer
+ * writes a padding marker and restarts at offset 0.
+ * Capacity is in bytes and must be a power of two, indices are free running
+ * 64-bit byte counters masked into the ring.
+ */
+template <uint32_t CAPACITY>
+class SpscByteRing {
+  static_assert(CAPACITY >= 64 && (CAPACITY & (CAPACITY - 1)) == 0,
+                "SpscByteRing capacity must be a power of two of at least 64");
+
+  using Index = uint64_t;
+  using Header = uint64_t;
+
+ public:
+  static constexpr uint32_t RECORD_ALIGN = 8;
+  static constexpr uint32_t HEADER_SIZE = sizeof(Header);
+  static_assert(HEADER_SIZE % RECORD_ALIGN == 0,
+                "SpscByteRing header must keep payloads aligned");
+
+  // Any record up to half of the ring is guaranteed to fit once the consumer
+  // drained the ring, even when the write position forces a wrap
+  static constexpr uint32_t MAX_RECORD_SIZE = CAPACITY / 2 - HEADER_SIZE;
+
+ public:
+  SpscByteRing(const SpscByteRing &_) = delete;
+  SpscByteRing &operator=(const SpscByteRing &_) = delete;
+
+  SpscByteRing() {
+    data_ = static_cast<char *>(
+        operator new[](CAPACITY, std::align_val_t{CACHE_LINE_SIZE}));
+    write_index_ = 0;
+    read_index_ = 0;
+    read_index_cache_ = 0;
+    write_index_cache_ = 0;
+  }
+
+  ~SpscByteRing() {
+    operator delete[](data_, std::align_val_t{CACHE_LINE_SIZE});
+  }
+
+ public:
+  // Reserve a contiguous writable region of size bytes, the span is empty
+  // when the ring does not have enough free space or size is larger than
+  // MAX_RECORD_SIZE. The region is RECORD_ALIGN aligned so values of up to
+  // 8 byte alignment can be built in place. Nothing is visible to the
+  // consumer until Commit
+  // Only producer thread should call this method
+  std::span<char> Reserve(const uint32_t size) noexcept {
+    if (size > MAX_RECORD_SIZE) [[unlikely]]
+      return {};
+
+    const auto curr_write = write_index_.load(std::memory_order_relaxed);
+    const auto offset = Offset(curr_write);
+    const auto contiguous = CAPACITY - offset;
+
+    const auto record_size = RecordSize(size);
+    const uint32_t padding = record_size > contiguous ? contiguous : 0;
+
+    if (!HasSpace(curr_write, padding + record_size)) return {};
+
+    if (padding) [[unlikely]]
+      WriteHeader(offset, PADDING);
+
+    reserved_index_ = curr_write + padding;
+    return {data_ + Offset(reserved_index_) + HEADER_SIZE, size};
+  }
+
+  // Publish the record returned by the last Reserve, size may be smaller
+  // than the reserved size
+  // Only producer thread should call this method
+  void Commit(const uint32_t size) noexcept {
+    WriteHeader(Offset(reserved_index_), size);
+    write_index_.store(reserved_index_ + RecordSize(size),
+                       std::memory_order_release);
+  }
+
+  // Copy size bytes from data into the ring as a single record
+  // Only producer thread should call this method
+  bool Write(const void *data, const uint32_t size) noexcept {
+    auto buffer = Reserve(size);
+    if (buffer.data() == nullptr) return false;
+
+    std::memcpy(buffer.data(), data, size);
+    Commit(size);
+    return true;
+  }
+
+  // View the next record in place, the span is empty when the ring is empty
+  // and stays valid until Release
+  // Only consumer thread should call this method
+  std::span<const char> Peek() noexcept {
+    auto curr_read = read_index_.load(std::memory_order_relaxed);
+    if (!HasData(curr_read)) return {};
+
+    auto size = ReadHeader(Offset(curr_read));
+    if (size == PADDING) [[unlikely]] {
+      // padding and the record behind it are published together
+      curr_read += CAPACITY - Offset(curr_read);
+      size = ReadHeader(0);
+    }
+
+    peeked_index_ = curr_read + RecordSize(size);
+    return {data_ + Offset(curr_read) + HEADER_SIZE, size};
+  }
+
+  // Hand the record returned by the last Peek back to the producer
+  // Only consumer thread should call this method
+  void Release() noexcept {
+    read_index_.store(peeked_index_, std::memory_order_release);
+  }
+
+  // Invoke functor in place on every record available at call time, the
+  // read index is published once for the whole batch
+  // Only consumer thread should call this method
+  template <typename Functor>
+  size_t ConsumeAll(const Functor &functor) {
+    const auto curr_write = write_index_.load(std::memory_order_acquire);
+    auto curr_read = read_index_.load(std::memory_order_relaxed);
+
+    size_t count = 0;
+    while (curr_read != curr_write) {
+      auto size = ReadHeader(Offset(curr_read));
+      if (size == PADDING) [[unlikely]] {
+        curr_read += CAPACITY - Offset(curr_read);
+        continue;
+      }
+
+      functor(std::span<const char>{data_ + Offset(curr_read) + HEADER_SIZE,
+                                    size});
+      curr_read += RecordSize(size);
+      count += 1;
+    }
+
+    write_index_cache_ = curr_write;
+    if (count) read_index_.store(curr_read, std::memory_order_release);
+    return count;
+  }
+
+  bool IsEmpty() const noexcept {
+    const auto curr_read = read_index_.load(std::memory_order_acquire);
+    const auto curr_write = write_index_.load(std::memory_order_acquire);
+    return curr_read == curr_write;
+  }
+
+  // Bytes in use including record headers and wrap padding
+  size_t BytesUsedGuess() const noexcept {
+    const auto curr_read = read_index_.load(std::memory_order_acquire);
+    const auto curr_write = write_index_.load(std::memory_order_acquire);
+    return curr_write - curr_read;
+  }
+
+  static constexpr uint32_t Capacity() noexcept { return CAPACITY; }
+
+ private:
+  static constexpr Header PADDING = ~Header{0};
+
+  static constexpr uint32_t Offset(const Index idx) noexcept {
+    return idx & (CAPACITY - 1);
+  }
+
+  static constexpr uint32_t RecordSize(const uint32_t size) noexcept {
+    return (HEADER_SIZE + size + RECORD_ALIGN - 1) & ~(RECORD_ALIGN - 1);
+  }
+
+  void WriteHeader(const uint32_t offset, const Header header) noexcept {
+    std::memcpy(data_ + offset, &header, HEADER_SIZE);
+  }
+
+  Header ReadHeader(const uint32_t offset) const noexcept {
+    Header header;
+    std::memcpy(&header, data_ + offset, HEADER_SIZE);
+    return header;
+  }
+
+  // Producer side check, the consumer index is only reloaded when the cached
+  // copy says there is not enough room
+  bool HasSpace(const Index curr_write, const uint32_t size) noexcept {
+    if (curr_write + size - read_index_cache_ > CAPACITY) [[unlikely]] {
+      read_index_cache_ = read_index_.load(std::memory_order_acquire);
+      return curr_write + size - read_index_cache_ <= CAPACITY;
+    }
+    return true;
+  }
+
+  // Consumer side check, the producer index is only reloaded when the cached
+  // copy says the ring is empty
+  bool HasData(const Index curr_read) noexcept {
+    if (curr_read == write_index_cache_) [[unlikely]] {
+      write_index_cache_ = write_index_.load(std::memory_order_acquire);
+      return curr_read != write_index_cache_;
+    }
+    return true;
+  }
+
+ private:
+  using AtomicIndex = std::atomic<Index>;
+  static constexpr std::size_t CACHE_LINE_SIZE =
+#ifdef __cpp_lib_hardware_interference_size
+      std::hardware_destructive_interference_size;
+#else
+      64;
+#endif
+
+ private:
+  char *data_;
+
+  // producer owned cache line
+  alignas(CACHE_LINE_SIZE) AtomicIndex write_index_;
+  Index read_index_cache_;
+  Index reserved_index_{0};
+
+  // consumer owned cache line
+  alignas(CACHE_LINE_SIZE) AtomicIndex read_index_;
+  Index write_index_cache_;
+  Index peeked_index_{0};
+
+  char pad_0_[CACHE_LINE_SIZE - sizeof(AtomicIndex) - 2 * sizeof(Index)];
+};
+
+}  // namespace hermes::container
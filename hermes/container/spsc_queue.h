@@ -1,32 +1,118 @@
 #pragma once
 
+#include <algorithm>
 #include <atomic>
+#include <chrono>
 #include <memory>
 #include <new>
 #include <optional>
+#include <span>
 #include <string>
+#include <type_traits>
+
+#include "hermes/container/queue_instrumentation.h"
+#include "hermes/container/ring_memory.h"
+#include "hermes/container/wait_strategy.h"
 
 namespace hermes::container {
 
+namespace detail {
+
+/**
+ * Wraparound over MAX_SIZE + 1 slots, one dummy slot is kept empty to tell a
+ * full queue from an empty one
+ */
+template <uint32_t MAX_SIZE>
+struct SpscModuloIndex {
+  using Index = uint32_t;
+  static constexpr size_t SLOTS = size_t(MAX_SIZE) + 1;
+
+  static constexpr Index Slot(const Index idx) noexcept { return idx; }
+
+  // n never exceeds MAX_SIZE, so one subtraction replaces the modulo
+  static constexpr Index Advance(const Index idx, const uint32_t n) noexcept {
+    const auto next = size_t(idx) + n;
+    return next >= SLOTS ? next - SLOTS : next;
+  }
+
+  static constexpr Index Used(const Index write, const Index read) noexcept {
+    return write >= read ? write - read : write + SLOTS - read;
+  }
+
+  static constexpr bool IsFull(const Index write, const Index read) noexcept {
+    return Advance(write, 1) == read;
+  }
+};
+
+/**
+ * Power of two capacity, indices are free running 64-bit counters masked into
+ * the ring so every slot is usable and the size is a plain subtraction
+ */
+template <uint32_t MAX_SIZE>
+struct SpscMaskIndex {
+  using Index = uint64_t;
+  static constexpr size_t SLOTS = MAX_SIZE;
+
+  static constexpr Index Slot(const Index idx) noexcept {
+    return idx & (MAX_SIZE - 1);
+  }
+
+  static constexpr Index Advance(const Index idx, const uint32_t n) noexcept {
+    return idx + n;
+  }
+
+  static constexpr Index Used(const Index write, const Index read) noexcept {
+    return write - read;
+  }
+
+  static constexpr bool IsFull(const Index write, const Index read) noexcept {
+    return write - read == MAX_SIZE;
+  }
+};
+
+template <uint32_t MAX_SIZE>
+using SpscIndex =
+    std::conditional_t<(MAX_SIZE & (MAX_SIZE - 1)) == 0,
+                       SpscMaskIndex<MAX_SIZE>, SpscModuloIndex<MAX_SIZE>>;
+
+}  // namespace detail
+
 /**
  * Single Producer Single Consumer Queue
+ *
+ * Power of two MAX_SIZE selects mask based wraparound, any other capacity
+ * falls back to modulo indices with one dummy slot. WaitStrategy decides how
+ * ReadWait waits for the producer, see wait_strategy.h. Instrumentation
+ * optionally records queue residency time and occupancy, see
+ * queue_instrumentation.h
  */
-template <typename T, uint32_t MAX_SIZE>
+template <typename T, uint32_t MAX_SIZE, typename WaitStrategy = BusySpinWait,
+          typename Instrumentation = NoQueueInstrumentation>
 class SpscQueue {
+  static_assert(MAX_SIZE > 0, "SpscQueue capacity must be positive");
+
+  using IndexPolicy = detail::SpscIndex<MAX_SIZE>;
+  using Index = typename IndexPolicy::Index;
+
  public:
   SpscQueue(const SpscQueue &_) = delete;
   SpscQueue &operator=(const SpscQueue &_) = delete;
 
-  SpscQueue() {
-    // allocate one extra slot for dummy node
-    data_ = static_cast<T *>(operator new[](sizeof(T) * (MAX_SIZE + 1)));
+  // options select huge page, prefaulted or NUMA bound ring storage, the
+  // default allocates with operator new
+  explicit SpscQueue(const RingMemoryOptions &options = {})
+      : memory_{sizeof(T) * IndexPolicy::SLOTS, options} {
+    data_ = static_cast<T *>(memory_.Data());
+    if constexpr (Instrumentation::ENABLED)
+      instrumentation_.Init(IndexPolicy::SLOTS);
     write_index_ = 0;
     read_index_ = 0;
+    read_index_cache_ = 0;
+    write_index_cache_ = 0;
   }
 
   ~SpscQueue() {
     while (!IsEmpty()) PopFront();
-    operator delete[](data_);
   }
 
  public:
@@ -34,13 +120,14 @@ class SpscQueue {
   // Only producer thread should call this method
   template <typename... Args>
   bool Write(Args &&...args) {
-    const auto curr_read = read_index_.load(std::memory_order_acquire);
     const auto curr_write = write_index_.load(std::memory_order_relaxed);
-    const auto next_write = (curr_write + 1) % (MAX_SIZE + 1);
 
-    if (next_write != curr_read) {
-      new (data_ + curr_write) T{std::forward<decltype(args)>(args)...};
-      write_index_.store(next_write, std::memory_order_release);
+    if (HasSpace(curr_write)) {
+      new (SlotAt(curr_write)) T{std::forward<decltype(args)>(args)...};
+      OnWrite(curr_write, 1);
+      write_index_.store(IndexPolicy::Advance(curr_write, 1),
+                         std::memory_order_release);
+      wait_strategy_.Notify();
       return true;
     }
 
@@ -51,19 +138,21 @@ class SpscQueue {
   // Read the last value from the queue
   // Only consumer thread should can this method
   bool Read(T &record) {
-    auto curr_write = write_index_.load(std::memory_order_acquire);
     auto curr_read = read_index_.load(std::memory_order_relaxed);
 
-    if (curr_read != curr_write) {
+    if (HasData(curr_read)) {
+      OnRead(curr_read);
+
+      auto *slot = SlotAt(curr_read);
       if constexpr (std::is_move_assignable<T>::value)
-        record = std::move(data_[curr_read]);
+        record = std::move(*slot);
       else
-        record = data_[curr_read];
+        record = *slot;
 
       // destroy old object
-      data_[curr_read].~T();
+      slot->~T();
 
-      read_index_.store((curr_read + 1) % (MAX_SIZE + 1),
+      read_index_.store(IndexPolicy::Advance(curr_read, 1),
                         std::memory_order_release);
       return true;
     }
@@ -73,19 +162,21 @@ class SpscQueue {
   }
 
   std::optional<T> Read() {
-    auto curr_write = write_index_.load(std::memory_order_acquire);
     auto curr_read = read_index_.load(std::memory_order_relaxed);
 
-    if (curr_read != curr_write) {
+    if (HasData(curr_read)) {
+      OnRead(curr_read);
+
+      auto *slot = SlotAt(curr_read);
       auto ret = std::optional<T>{};
       if constexpr (std::is_move_constructible<T>::value)
-        ret = std::move(data_[curr_read]);
+        ret = std::move(*slot);
       else
-        ret = data_[curr_read];
+        ret = *slot;
 
       // destroy old object
-      data_[curr_read].~T();
-      read_index_.store((curr_read + 1) % (MAX_SIZE + 1),
+      slot->~T();
+      read_index_.store(IndexPolicy::Advance(curr_read, 1),
                         std::memory_order_release);
 
       return ret;
@@ -95,22 +186,127 @@ class SpscQueue {
     return {};
   }
 
+  // Wait up to timeout for a value using WaitStrategy, then read it
+  // Only consumer thread should call this method
+  bool ReadWait(T &record, const std::chrono::nanoseconds timeout) {
+    return WaitForData(timeout) && Read(record);
+  }
+
+  std::optional<T> ReadWait(const std::chrono::nanoseconds timeout) {
+    if (!WaitForData(timeout)) return {};
+    return Read();
+  }
+
+  // Claim up to n contiguous free slots for in place construction, the
+  // returned span may be shorter than n when the queue is nearly full or the
+  // slots wrap around the end of the ring. Slots are raw storage, construct
+  // objects with placement new and publish them with Commit
+  // Only producer thread should call this method
+  std::span<T> Claim(const uint32_t n) noexcept {
+    const auto curr_write = write_index_.load(std::memory_order_relaxed);
+
+    auto free = FreeSlots(curr_write, read_index_cache_);
+    if (free < n) {
+      read_index_cache_ = read_index_.load(std::memory_order_acquire);
+      free = FreeSlots(curr_write, read_index_cache_);
+    }
+
+    return {SlotAt(curr_write),
+            std::min({size_t(n), free, ContiguousSlots(curr_write)})};
+  }
+
+  // Publish the first n slots returned by the last Claim
+  // Only producer thread should call this method
+  void Commit(const uint32_t n) noexcept {
+    const auto curr_write = write_index_.load(std::memory_order_relaxed);
+    OnWrite(curr_write, n);
+    write_index_.store(IndexPolicy::Advance(curr_write, n),
+                       std::memory_order_release);
+    wait_strategy_.Notify();
+  }
+
+  // Peek up to n contiguous readable values without moving them out of the
+  // queue, the returned span may be shorter than n for the same reasons as
+  // Claim. Values stay valid until they are released
+  // Only consumer thread should call this method
+  std::span<T> Peek(const uint32_t n) noexcept {
+    const auto curr_read = read_index_.load(std::memory_order_relaxed);
+
+    size_t used = IndexPolicy::Used(write_index_cache_, curr_read);
+    if (used < n) {
+      write_index_cache_ = write_index_.load(std::memory_order_acquire);
+      used = IndexPolicy::Used(write_index_cache_, curr_read);
+    }
+
+    return {SlotAt(curr_read),
+            std::min({size_t(n), used, ContiguousSlots(curr_read)})};
+  }
+
+  // Destroy the first n values returned by the last Peek and hand their slots
+  // back to the producer
+  // Only consumer thread should call this method
+  void Release(const uint32_t n) noexcept {
+    const auto curr_read = read_index_.load(std::memory_order_relaxed);
+
+    OnRead(curr_read, n);
+
+    auto *slot = SlotAt(curr_read);
+    for (uint32_t i = 0; i < n; ++i) slot[i].~T();
+
+    read_index_.store(IndexPolicy::Advance(curr_read, n),
+                      std::memory_order_release);
+  }
+
   // queue must not be empty
   void PopFront() noexcept {
     auto curr_read = read_index_.load(std::memory_order_relaxed);
-    data_[curr_read].~T();
-    read_index_.store((curr_read + 1) % (MAX_SIZE + 1),
+    SlotAt(curr_read)->~T();
+    read_index_.store(IndexPolicy::Advance(curr_read, 1),
                       std::memory_order_release);
   }
 
+  // Invoke functor on the front value in place, then destroy it
+  // Only consumer thread should call this method
   template <typename Functor>
   bool ConsumeOne(const Functor &functor) {
+    auto curr_read = read_index_.load(std::memory_order_relaxed);
+
+    if (!HasData(curr_read)) return false;
+
+    OnRead(curr_read);
+
+    auto *slot = SlotAt(curr_read);
+    functor(*slot);
+    slot->~T();
+    read_index_.store(IndexPolicy::Advance(curr_read, 1),
+                      std::memory_order_release);
     return true;
   }
 
+  // Invoke functor in place on every value available at call time. The read
+  // index is published once for the whole batch, so the producer only sees
+  // the consumer cache line change once per drain.
+  // Only consumer thread should call this method
   template <typename Functor>
-  bool ConsumeAll(const Functor &functor) {
-    return true;
+  size_t ConsumeAll(const Functor &functor) {
+    auto curr_write = write_index_.load(std::memory_order_acquire);
+    auto curr_read = read_index_.load(std::memory_order_relaxed);
+
+    size_t count = 0;
+    while (curr_read != curr_write) {
+      OnRead(curr_read);
+
+      auto *slot = SlotAt(curr_read);
+      functor(*slot);
+      slot->~T();
+
+      curr_read = IndexPolicy::Advance(curr_read, 1);
+      count += 1;
+    }
+
+    write_index_cache_ = curr_write;
+    if (count) read_index_.store(curr_read, std::memory_order_release);
+    return count;
   }
 
   bool ReadAvailable() const noexcept { return !IsEmpty(); }
@@ -118,7 +314,7 @@ class SpscQueue {
   bool WriteAvailable() const noexcept {
     const auto curr_read = read_index_.load(std::memory_order_acquire);
     const auto curr_write = write_index_.load(std::memory_order_acquire);
-    return (curr_write + 1) % (MAX_SIZE + 1) != curr_read;
+    return !IndexPolicy::IsFull(curr_write, curr_read);
   }
 
   bool IsEmpty() const noexcept {
@@ -130,15 +326,72 @@ class SpscQueue {
   size_t SizeGuess() const noexcept {
     const auto curr_read = read_index_.load(std::memory_order_acquire);
     const auto curr_write = write_index_.load(std::memory_order_acquire);
-
-    auto ret = curr_write - curr_read;
-    return ret < 0 ? (ret + MAX_SIZE + 1) : ret;
+    return IndexPolicy::Used(curr_write, curr_read);
   }
 
   static constexpr uint32_t Capacity() noexcept { return MAX_SIZE; }
 
+  const Instrumentation &Stats() const noexcept { return instrumentation_; }
+
+ private:
+  T *SlotAt(const Index idx) const noexcept {
+    return data_ + IndexPolicy::Slot(idx);
+  }
+
+  static constexpr size_t FreeSlots(const Index write,
+                                    const Index read) noexcept {
+    return MAX_SIZE - IndexPolicy::Used(write, read);
+  }
+
+  static constexpr size_t ContiguousSlots(const Index idx) noexcept {
+    return IndexPolicy::SLOTS - IndexPolicy::Slot(idx);
+  }
+
+  void OnWrite(const Index curr_write, const uint32_t n) noexcept {
+    if constexpr (Instrumentation::ENABLED) {
+      // the cached read index only moves when the queue looks full, so the
+      // instrumented path pays for a fresh load to report true occupancy
+      const auto curr_read = read_index_.load(std::memory_order_acquire);
+      instrumentation_.OnWrite(
+          IndexPolicy::Slot(curr_write), n,
+          IndexPolicy::Used(IndexPolicy::Advance(curr_write, n), curr_read));
+    }
+  }
+
+  void OnRead(const Index curr_read, const uint32_t n = 1) noexcept {
+    if constexpr (Instrumentation::ENABLED) {
+      for (uint32_t i = 0; i < n; ++i)
+        instrumentation_.OnRead(IndexPolicy::Slot(curr_read) + i);
+    }
+  }
+
+  bool WaitForData(const std::chrono::nanoseconds timeout) {
+    const auto curr_read = read_index_.load(std::memory_order_relaxed);
+    return wait_strategy_.Wait([&]() { return HasData(curr_read); }, timeout);
+  }
+
+  // Producer side check, the consumer index is only reloaded when the cached
+  // copy says the queue is full
+  bool HasSpace(const Index curr_write) noexcept {
+    if (IndexPolicy::IsFull(curr_write, read_index_cache_)) [[unlikely]] {
+      read_index_cache_ = read_index_.load(std::memory_order_acquire);
+      return !IndexPolicy::IsFull(curr_write, read_index_cache_);
+    }
+    return true;
+  }
+
+  // Consumer side check, the producer index is only reloaded when the cached
+  // copy says the queue is empty
+  bool HasData(const Index curr_read) noexcept {
+    if (curr_read == write_index_cache_) [[unlikely]] {
+      write_index_cache_ = write_index_.load(std::memory_order_acquire);
+      return curr_read != write_index_cache_;
+    }
+    return true;
+  }
+
  private:
-  using AtomicIndex = std::atomic<uint32_t>;
+  using AtomicIndex = std::atomic<Index>;
   static constexpr std::size_t CACHE_LINE_SIZE =
 #ifdef __cpp_lib_hardware_interference_size
       std::hardware_destructive_interference_size;
@@ -147,12 +400,23 @@ class SpscQueue {
 #endif
 
  private:
+  RingMemory memory_;
   T *data_;
 
+  // producer owned cache line
   alignas(CACHE_LINE_SIZE) AtomicIndex write_index_;
+  Index read_index_cache_;
+
+  // consumer owned cache line
   alignas(CACHE_LINE_SIZE) AtomicIndex read_index_;
+  Index write_index_cache_;
+
+  char pad_0_[CACHE_LINE_SIZE - sizeof(AtomicIndex) - sizeof(Index)];
+
+  // touched by both sides only when the strategy parks the consumer
+  [[no_unique_address]] WaitStrategy wait_strategy_;
 
-  char pad_0_[CACHE_LINE_SIZE - sizeof(AtomicIndex)];
+  [[no_unique_address]] Instrumentation instrumentation_;
 };
 
 }  // namespace hermes::container
@@ -1,112 +1,313 @@
 #pragma once
 
-#include <fcntl.h>
 #include <glog/logging.h>
-#include <sys/mman.h>
 #include <sys/stat.h>
 #include <unistd.h>
 
 #include <atomic>
+#include <chrono>
+#include <cstring>
 #include <memory>
 #include <optional>
-#include <queue>
 #include <string>
+#include <type_traits>
+
+#include "hermes/container/mmap_file.h"
+#include "hermes/container/wait_strategy.h"
 
 namespace hermes::container {
 
+namespace detail {
+
+/**
+ * Layout shared by every process attached to an mmap backed queue
+ *
+ *   line 0: MMapQueueMeta, written once when the file is created
+ *   line 1: producer index
+ *   line 2: consumer index
+ *   line 3: wait strategy state, e.g. the futex word of SharedFutexWait
+ *   data  : capacity slots of elem_size bytes
+ */
+struct MMapQueueMeta : MMapMeta {
+  static constexpr uint64_t MAGIC = 0x51434d5345524d48;  // "HMRESMCQ"
+  static constexpr uint32_t VERSION = 2;
+
+  // non zero when the producer notifies a waiting consumer
+  uint32_t notify;
+};
+
+}  // namespace detail
+
 /**
  * Single-Producer-Single-Consumer Queue mmap file backed
+ *
+ * Producer and consumer can live in different processes mapping the same
+ * file, shared memory object or memfd. Indices are free running counters
+ * stored in the file, so a consumer that restarts with reset = false resumes
+ * where it stopped
+ *
+ * PopWait waits for the producer with WaitStrategy, see wait_strategy.h. Its
+ * state lives in the header so an idle consumer can sleep with
+ * SharedFutexWait and the producer only issues a wake when it announced it
+ * is sleeping. Both sides must use the same strategy
  */
-template <typename T>
+template <typename T, typename WaitStrategy = BusySpinWait>
 class SpscQueueMMap {
- public:
-  SpscQueue() {}
+  static_assert(std::is_trivially_copyable<T>::value,
+                "SpscQueueMMap values are shared across processes and must be "
+                "trivially copyable");
+  static_assert(detail::IsProcessShared<WaitStrategy>::value,
+                "SpscQueueMMap wait strategy must work across processes");
 
-  ~SpscQueue() {
-    LOG(INFO) << "Closing mmap file data";
+ public:
+  SpscQueueMMap(const SpscQueueMMap &_) = delete;
+  SpscQueueMMap &operator=(const SpscQueueMMap &_) = delete;
 
-    munmap(mmap_ptr_, file_size_);
-    close(fd_);
-  }
+  SpscQueueMMap() {}
 
  public:
-  void Init(const std::string &file_path, const size_t file_size,
-            const bool reset) noexcept {
+  // Map the queue file at file_path. With reset the file is resized to
+  // file_size and the queue starts empty, otherwise an existing queue is
+  // reattached with its indices and file_size is only used for a new file.
+  // options control prefaulting, mlock and madvise hints of the mapping.
+  // Attaching waits up to MMapHeader::ATTACH_TIMEOUT for the creating
+  // process to publish the header. Returns false when it does not or when
+  // the header does not match this queue
+  bool Init(const std::string &file_path, const size_t file_size,
+            const bool reset, const MMapOptions &options = {}) noexcept {
     LOG(INFO) << "Initializing spsc_queue at path: " << file_path;
+    HEADER.CheckFileSize(file_size, sizeof(T));
+    return Attach(file_.Open(file_path, file_size, reset, options),
+                  file_path);
+  }
 
-    CHECK(file_size > HEADER_SIZE)
-        << "File size (" << file_size
-        << " bytes) should greater than header size (" << HEADER_SIZE
-        << " bytes)";
+  // Same as Init on the POSIX shared memory object shm_name, the queue never
+  // touches disk
+  bool InitShm(const std::string &shm_name, const size_t file_size,
+               const bool reset, const MMapOptions &options = {}) noexcept {
+    LOG(INFO) << "Initializing spsc_queue at shm: " << shm_name;
+    HEADER.CheckFileSize(file_size, sizeof(T));
+    return Attach(file_.OpenShm(shm_name, file_size, reset, options),
+                  shm_name);
+  }
 
-    file_size_ = file_size;
-    fd_ = open(file_path.c_str(), O_RDWR | O_CREAT, 0666);
+  // Create the queue in a new anonymous memfd. Share Fd() with the other
+  // process over a unix socket (SendFd) and attach there with InitFd
+  bool InitMemfd(const std::string &name, const size_t file_size,
+                 const MMapOptions &options = {}) noexcept {
+    LOG(INFO) << "Initializing spsc_queue at memfd: " << name;
+    HEADER.CheckFileSize(file_size, sizeof(T));
+    return Attach(file_.OpenMemfd(name, file_size, options), name);
+  }
 
-    CHECK(fd_ != -1) << "Error opening file";
-    if (reset) CHECK(ftruncate(fd_, file_size) != -1) << "Error resizing file";
+  // Attach to an existing queue through fd, the queue takes ownership of it.
+  // fd must already hold a queue, an empty file is never sized here. Returns
+  // false, closing fd, when it does not
+  bool InitFd(const int fd, const MMapOptions &options = {}) noexcept {
+    LOG(INFO) << "Initializing spsc_queue at fd: " << fd;
 
-    mmap_ptr_ = static_cast<char *>(
-        mmap(nullptr, file_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0));
+    struct stat stat_buf;
+    if (fstat(fd, &stat_buf) != 0) {
+      LOG(ERROR) << "Error getting size of fd: " << fd;
+      if (fd != -1) close(fd);
+      return false;
+    }
+    if (static_cast<size_t>(stat_buf.st_size) < HEADER_SIZE + sizeof(T)) {
+      LOG(ERROR) << "File at fd " << fd << " (" << stat_buf.st_size
+                 << " bytes) does not hold a spsc_queue";
+      close(fd);
+      return false;
+    }
+
+    return Attach(file_.OpenFd(fd, HEADER_SIZE + sizeof(T), false, options),
+                  "fd " + std::to_string(fd));
+  }
 
-    CHECK(data_ != MAP_FAILED) << "Error mapping file at path: " << file_path;
+  // Only producer process should call this method
+  bool Push(const T &value) noexcept {
+    const auto curr_write = write_index_->load(std::memory_order_relaxed);
 
-    head_idx_ = reinterpret_cast<std::atomic<int> *>(mmap_ptr_);
-    tail_idx_ = reinterpret_cast<std::atomic<int> *>(mmap_ptr_ + CACHE_LINE);
+    if (curr_write - read_index_cache_ == capacity_) [[unlikely]] {
+      read_index_cache_ = read_index_->load(std::memory_order_acquire);
+      if (curr_write - read_index_cache_ == capacity_) return false;
+    }
+
+    std::memcpy(data_ + (curr_write & mask_), &value, sizeof(T));
+    write_index_->store(curr_write + 1, std::memory_order_release);
+    wait_strategy_->Notify();
+    return true;
+  }
 
-    data_ = static_cast<T *>(mmap_ptr_ + HEADER_SIZE);
-    size_ = 0;
-    max_size_ = (file_size - 2 * sizeof(std::atomic<int>)) / sizeof(T);
+  // Only consumer process should call this method
+  bool Pop(T &record) noexcept {
+    const auto curr_read = read_index_->load(std::memory_order_relaxed);
+    if (!HasData(curr_read)) return false;
+
+    std::memcpy(&record, data_ + (curr_read & mask_), sizeof(T));
+    read_index_->store(curr_read + 1, std::memory_order_release);
+    return true;
+  }
+
+  // T needs no default constructor, the value is copied out of its slot
+  std::optional<T> Pop() noexcept {
+    const auto curr_read = read_index_->load(std::memory_order_relaxed);
+    if (!HasData(curr_read)) return {};
+
+    std::optional<T> ret{data_[curr_read & mask_]};
+    read_index_->store(curr_read + 1, std::memory_order_release);
+    return ret;
+  }
 
-    head_idx_->store(0, std::memory_order_release);
-    tail_idx_->store(1, std::memory_order_release);
+  // Wait up to timeout for a value, how the consumer waits depends on
+  // WaitStrategy
+  // Only consumer process should call this method
+  bool PopWait(T &record, const std::chrono::nanoseconds timeout) {
+    return WaitForData(timeout) && Pop(record);
+  }
 
-    LOG(INFO) << "Successfully initialized spsc_queue at path: " << file_path;
+  std::optional<T> PopWait(const std::chrono::nanoseconds timeout) {
+    if (!WaitForData(timeout)) return {};
+    return Pop();
   }
 
-  typename std::enable_if<std::is_copy_constructible<T>::value, bool>::type
-  Push(const T &data) {
-    return PushImpl(data);
+  // Invoke functor in place on every value available at call time, the read
+  // index is published once for the whole batch
+  // Only consumer process should call this method
+  template <typename Functor>
+  size_t ConsumeAll(const Functor &functor) {
+    const auto curr_write = write_index_->load(std::memory_order_acquire);
+    const auto curr_read = read_index_->load(std::memory_order_relaxed);
+
+    for (auto idx = curr_read; idx != curr_write; ++idx)
+      functor(static_cast<const T &>(data_[idx & mask_]));
+
+    write_index_cache_ = curr_write;
+    if (curr_read != curr_write)
+      read_index_->store(curr_write, std::memory_order_release);
+    return curr_write - curr_read;
   }
 
-  typename std::enable_if<std::is_move_constructible<T>::value, void>::type
-  Push(T &&data) {
-    return PushImpl(data);
+  bool IsEmpty() const noexcept { return SizeGuess() == 0; }
+
+  size_t SizeGuess() const noexcept {
+    const auto curr_read = read_index_->load(std::memory_order_acquire);
+    const auto curr_write = write_index_->load(std::memory_order_acquire);
+    return curr_write - curr_read;
   }
 
-  std::optional<T> Pop() {
-    // TODO: implement
+  size_t Capacity() const noexcept { return capacity_; }
+
+  // Backing fd, send it to another process to share a memfd queue
+  int Fd() const noexcept { return file_.Fd(); }
+
+  // Time Init spent locking and prefaulting the mapping
+  std::chrono::nanoseconds PrefaultTime() const noexcept {
+    return file_.PrefaultTime();
   }
 
  private:
-  bool PushImpl(auto &&value) {
-    auto head = head_idx_->load(std::memory_order_acquire);
-    auto tail = tail_idx_->load(std::memory_order_acquire);
-    if (head == tail) [[unlikely]]
+  bool HasData(const uint64_t curr_read) noexcept {
+    if (curr_read == write_index_cache_) {
+      write_index_cache_ = write_index_->load(std::memory_order_acquire);
+      return curr_read != write_index_cache_;
+    }
+    return true;
+  }
+
+  bool WaitForData(const std::chrono::nanoseconds timeout) {
+    const auto curr_read = read_index_->load(std::memory_order_relaxed);
+    return wait_strategy_->Wait(
+        [&] {
+          write_index_cache_ = write_index_->load(std::memory_order_acquire);
+          return curr_read != write_index_cache_;
+        },
+        timeout);
+  }
+
+  bool Attach(const bool create, const std::string &name) noexcept {
+    mmap_ptr_ = file_.Data();
+    file_size_ = file_.Size();
+
+    meta_ = reinterpret_cast<detail::MMapQueueMeta *>(mmap_ptr_);
+    write_index_ = reinterpret_cast<AtomicIndex *>(mmap_ptr_ + CACHE_LINE);
+    read_index_ = reinterpret_cast<AtomicIndex *>(mmap_ptr_ + 2 * CACHE_LINE);
+    wait_strategy_ =
+        reinterpret_cast<WaitStrategy *>(mmap_ptr_ + 3 * CACHE_LINE);
+    data_ = reinterpret_cast<T *>(mmap_ptr_ + HEADER_SIZE);
+
+    if (create)
+      CreateHeader();
+    else if (!ValidateHeader(name))
       return false;
 
-    auto *obj_ptr = static_cast<T *>(data_ + tail);
-    new (obj_ptr) T{std::forward<decltype(value)>(value)};
+    capacity_ = meta_->capacity;
+    mask_ = capacity_ - 1;
+    read_index_cache_ = read_index_->load(std::memory_order_acquire);
+    write_index_cache_ = write_index_->load(std::memory_order_acquire);
 
-    auto new_tail = (tail + 1) % max_size_;
-    tail_idx_->store(new_tail, std::memory_order_release);
+    LOG(INFO) << "Successfully initialized spsc_queue at " << name
+              << ", capacity = " << capacity_
+              << ", size = " << write_index_cache_ - read_index_cache_;
+    return true;
+  }
+
+  void CreateHeader() noexcept {
+    HEADER.Create(file_, HEADER.MaskCapacity(file_size_, sizeof(T)));
+    meta_->notify = NOTIFY;
+
+    new (write_index_) AtomicIndex{0};
+    new (read_index_) AtomicIndex{0};
+    new (wait_strategy_) WaitStrategy{};
+
+    HEADER.Publish(file_);
+  }
+
+  bool ValidateHeader(const std::string &name) noexcept {
+    if (!HEADER.Validate(file_, name,
+                         [&] { return meta_->capacity * sizeof(T); }))
+      return false;
 
+    if (meta_->notify != NOTIFY) {
+      LOG(ERROR) << "Wait strategy mismatch, file at " << name
+                 << (meta_->notify ? " notifies" : " does not notify")
+                 << " waiting consumers";
+      return false;
+    }
     return true;
   }
 
  private:
   static constexpr size_t CACHE_LINE = 64;
-  static constexpr size_t HEADER_SIZE = 2 * CACHE_LINE;
+  static constexpr size_t HEADER_SIZE = 4 * CACHE_LINE;
+  static constexpr uint32_t NOTIFY = !std::is_empty<WaitStrategy>::value;
+  static constexpr MMapHeader HEADER{
+      "spsc_queue", detail::MMapQueueMeta::MAGIC,
+      detail::MMapQueueMeta::VERSION, sizeof(T), HEADER_SIZE};
+
+  static_assert(sizeof(WaitStrategy) <= CACHE_LINE,
+                "wait strategy state must fit its header cache line");
+
+  using AtomicIndex = std::atomic<uint64_t>;
+  static_assert(AtomicIndex::is_always_lock_free,
+                "shared memory indices must be lock free");
 
  private:
-  int fd_;
-  size_t file_size_;
-  char *mmap_ptr_;
-
-  T *data_;
-  int max_size_;
-  int size_;
-  std::atomic<int> *head_idx_;
-  std::atomic<int> *tail_idx_;
+  MMapFile file_;
+  size_t file_size_{0};
+  char *mmap_ptr_{nullptr};
+
+  detail::MMapQueueMeta *meta_{nullptr};
+  T *data_{nullptr};
+  uint64_t capacity_{0};
+  uint64_t mask_{0};
+
+  AtomicIndex *write_index_{nullptr};
+  AtomicIndex *read_index_{nullptr};
+  WaitStrategy *wait_strategy_{nullptr};
+
+  // process local copies of the remote index
+  uint64_t read_index_cache_{0};
+  uint64_t write_index_cache_{0};
 };
 
 }  // namespace hermes::container
@@ -31,6 +31,8 @@ class Vector {
     size_ = rhs.size_;
 
     rhs.data_ = nullptr;
+    rhs.max_size_ = 0;
+    rhs.size_ = 0;
   }
 
   ~Vector() noexcept {
@@ -70,6 +72,8 @@ class Vector {
     max_size_ = rhs.max_size_;
 
     rhs.data_ = nullptr;
+    rhs.max_size_ = 0;
+    rhs.size_ = 0;
   }
 
  public:
@@ -107,7 +111,7 @@ class Vector {
     size_ -= 1;
   }
 
-  inline bool IsEmpty() const noexcept { return size_ > 0; }
+  inline bool IsEmpty() const noexcept { return size_ == 0; }
 
   inline size_t Size() const noexcept { return size_; }
 
@@ -115,20 +119,15 @@ class Vector {
 
   inline const T *Data() const noexcept { return data_; }
 
- private:
-  void InnerPushBack(auto &&value) {
-    if (size_ == max_size_) [[unlikely]] {
-      Resize();
-    }
+  inline T *Data() noexcept { return data_; }
 
-    new (data_ + size_) T(std::forward<decltype(value)>(value));
-    size_ += 1;
-  }
+  /**
+   * Grow the storage to hold at least n items without reallocating
+   */
+  void Reserve(const size_t n) {
+    if (n <= max_size_) return;
 
-  void Resize() {
-    const auto new_max_size = !max_size_ ? 1 : 2 * max_size_;
-    const auto new_data =
-        static_cast<T *>(operator new[](new_max_size * sizeof(T)));
+    const auto new_data = static_cast<T *>(operator new[](n * sizeof(T)));
 
     static_assert(std::is_copy_constructible<T>::value |
                       std::is_move_constructible<T>::value,
@@ -146,7 +145,28 @@ class Vector {
     if (data_ != nullptr) [[likely]]
       operator delete[](data_);
     data_ = new_data;
-    max_size_ = new_max_size;
+    max_size_ = n;
+  }
+
+  /**
+   * Shrink to or grow to n items, new items are default initialized so
+   * trivial types are left uninitialized, like storage for a bulk reader
+   */
+  void Resize(const size_t n) {
+    Reserve(n);
+    for (size_t i = n; i < size_; ++i) data_[i].~T();
+    for (size_t i = size_; i < n; ++i) new (data_ + i) T;
+    size_ = n;
+  }
+
+ private:
+  void InnerPushBack(auto &&value) {
+    if (size_ == max_size_) [[unlikely]] {
+      Reserve(!max_size_ ? 1 : 2 * max_size_);
+    }
+
+    new (data_ + size_) T(std::forward<decltype(value)>(value));
+    size_ += 1;
   }
 
  private:
@@ -0,0 +1,210 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <new>
+#include <optional>
+#include <type_traits>
+
+#include "hermes/container/spsc_queue.h"
+
+namespace hermes::container {
+
+/**
+ * Unbounded Single Producer Single Consumer Queue
+ *
+ * Values live in a linked list of cache aligned chunks of CHUNK_SIZE slots.
+ * Drained chunks are handed back to the producer through a bounded SpscQueue
+ * used as a free list, so a queue whose depth stays under
+ * MAX_FREE_CHUNKS * CHUNK_SIZE allocates nothing in steady state. Write never
+ * fails and never waits for the consumer
+ */
+template <typename T, uint32_t CHUNK_SIZE = 1024,
+          uint32_t MAX_FREE_CHUNKS = 64>
+class UnboundedSpscQueue {
+  static_assert(CHUNK_SIZE > 0, "UnboundedSpscQueue chunk must be non empty");
+
+  static constexpr std::size_t CACHE_LINE_SIZE =
+#ifdef __cpp_lib_hardware_interference_size
+      std::hardware_destructive_interference_size;
+#else
+      64;
+#endif
+
+  struct alignas(CACHE_LINE_SIZE) Chunk {
+    std::atomic<Chunk *> next{nullptr};
+    alignas(T) unsigned char storage[sizeof(T) * CHUNK_SIZE];
+
+    T *Slot(const uint32_t pos) noexcept {
+      return std::launder(reinterpret_cast<T *>(storage)) + pos;
+    }
+  };
+
+ public:
+  UnboundedSpscQueue(const UnboundedSpscQueue &_) = delete;
+  UnboundedSpscQueue &operator=(const UnboundedSpscQueue &_) = delete;
+
+  // preallocated chunks are parked on the free list so the first bursts do
+  // not allocate either
+  explicit UnboundedSpscQueue(const uint32_t preallocated_chunks = 0) {
+    head_chunk_ = tail_chunk_ = new Chunk{};
+    for (uint32_t i = 0; i < preallocated_chunks; ++i) {
+      auto *chunk = new Chunk{};
+      if (!free_chunks_.Write(chunk)) {
+        delete chunk;
+        break;
+      }
+    }
+
+    write_pos_ = 0;
+    read_pos_ = 0;
+    write_count_ = 0;
+    read_count_ = 0;
+    write_count_cache_ = 0;
+  }
+
+  ~UnboundedSpscQueue() {
+    ConsumeAll([](T &) {});
+
+    for (auto *chunk = head_chunk_; chunk;) {
+      auto *next = chunk->next.load(std::memory_order_relaxed);
+      delete chunk;
+      chunk = next;
+    }
+
+    free_chunks_.ConsumeAll([](Chunk *chunk) { delete chunk; });
+  }
+
+ public:
+  // Emplace value at the begin of the queue, links a new chunk when the
+  // current one is full
+  // Only producer thread should call this method
+  template <typename... Args>
+  void Write(Args &&...args) {
+    if (write_pos_ == CHUNK_SIZE) [[unlikely]] {
+      auto *chunk = NewChunk();
+      // published to the consumer together with the first value below
+      tail_chunk_->next.store(chunk, std::memory_order_relaxed);
+      tail_chunk_ = chunk;
+      write_pos_ = 0;
+    }
+
+    new (tail_chunk_->Slot(write_pos_))
+        T{std::forward<decltype(args)>(args)...};
+    write_pos_ += 1;
+
+    write_count_.store(write_count_.load(std::memory_order_relaxed) + 1,
+                       std::memory_order_release);
+  }
+
+  // Read the last value from the queue
+  // Only consumer thread should call this method
+  bool Read(T &record) {
+    return ConsumeOne([&](T &value) {
+      if constexpr (std::is_move_assignable<T>::value)
+        record = std::move(value);
+      else
+        record = value;
+    });
+  }
+
+  std::optional<T> Read() {
+    std::optional<T> ret;
+    ConsumeOne([&](T &value) { ret.emplace(std::move(value)); });
+    return ret;
+  }
+
+  // Invoke functor on the front value in place, then destroy it
+  // Only consumer thread should call this method
+  template <typename Functor>
+  bool ConsumeOne(const Functor &functor) {
+    const auto curr_read = read_count_.load(std::memory_order_relaxed);
+
+    if (curr_read == write_count_cache_) {
+      write_count_cache_ = write_count_.load(std::memory_order_acquire);
+      if (curr_read == write_count_cache_) return false;
+    }
+
+    ConsumeFront(functor);
+    read_count_.store(curr_read + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Invoke functor in place on every value available at call time, the read
+  // count is published once for the whole batch
+  // Only consumer thread should call this method
+  template <typename Functor>
+  size_t ConsumeAll(const Functor &functor) {
+    const auto curr_write = write_count_.load(std::memory_order_acquire);
+    const auto curr_read = read_count_.load(std::memory_order_relaxed);
+
+    for (auto i = curr_read; i != curr_write; ++i) ConsumeFront(functor);
+
+    write_count_cache_ = curr_write;
+    if (curr_read != curr_write)
+      read_count_.store(curr_write, std::memory_order_release);
+    return curr_write - curr_read;
+  }
+
+  bool IsEmpty() const noexcept { return SizeGuess() == 0; }
+
+  size_t SizeGuess() const noexcept {
+    const auto curr_read = read_count_.load(std::memory_order_acquire);
+    const auto curr_write = write_count_.load(std::memory_order_acquire);
+    return curr_write - curr_read;
+  }
+
+ private:
+  // Queue must not be empty
+  template <typename Functor>
+  void ConsumeFront(const Functor &functor) {
+    if (read_pos_ == CHUNK_SIZE) [[unlikely]] {
+      auto *drained = head_chunk_;
+      head_chunk_ = drained->next.load(std::memory_order_relaxed);
+      read_pos_ = 0;
+      RecycleChunk(drained);
+    }
+
+    auto *value = head_chunk_->Slot(read_pos_);
+    functor(*value);
+    value->~T();
+    read_pos_ += 1;
+  }
+
+  Chunk *NewChunk() {
+    Chunk *chunk;
+    if (free_chunks_.Read(chunk)) [[likely]] {
+      chunk->next.store(nullptr, std::memory_order_relaxed);
+      return chunk;
+    }
+    return new Chunk{};
+  }
+
+  void RecycleChunk(Chunk *chunk) {
+    if (!free_chunks_.Write(chunk)) [[unlikely]]
+      delete chunk;
+  }
+
+ private:
+  using AtomicCount = std::atomic<uint64_t>;
+
+ private:
+  // consumer to producer free list
+  SpscQueue<Chunk *, MAX_FREE_CHUNKS> free_chunks_;
+
+  // producer owned cache line
+  alignas(CACHE_LINE_SIZE) AtomicCount write_count_;
+  Chunk *tail_chunk_;
+  uint32_t write_pos_;
+
+  // consumer owned cache line
+  alignas(CACHE_LINE_SIZE) AtomicCount read_count_;
+  uint64_t write_count_cache_;
+  Chunk *head_chunk_;
+  uint32_t read_pos_;
+
+  char pad_0_[CACHE_LINE_SIZE - sizeof(AtomicCount) - sizeof(uint64_t) -
+              sizeof(Chunk *) - sizeof(uint32_t)];
+};
+
+}  // namespace hermes::container
@@ -0,0 +1,197 @@
+#pragma once
+
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <type_traits>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+namespace hermes::container {
+
+/**
+ * Wait strategies decide how a consumer waits for a producer.
+ *
+ * Every strategy provides
+ *   - Wait(ready, timeout): consumer side, block until ready() returns true
+ *     or the timeout expires, returns the last value of ready()
+ *   - Notify(): producer side, called after new data is published
+ *
+ * Stateless strategies work across processes as is, a stateful one must
+ * set PROCESS_SHARED to be placed in shared memory
+ */
+
+inline void CpuRelax() noexcept {
+#if defined(__x86_64__) || defined(__i386__)
+  _mm_pause();
+#elif defined(__aarch64__)
+  asm volatile("yield" ::: "memory");
+#endif
+}
+
+namespace detail {
+
+// Reading the clock on every spin would dominate a pause loop
+constexpr uint32_t DEADLINE_CHECK_INTERVAL = 128;
+
+template <typename Ready, typename Relax>
+bool SpinUntil(const Ready &ready, const std::chrono::nanoseconds timeout,
+               const Relax &relax) {
+  const auto deadline = std::chrono::steady_clock::now() + timeout;
+  for (uint32_t spin = 1;; ++spin) {
+    if (ready()) return true;
+    if (spin % DEADLINE_CHECK_INTERVAL == 0 &&
+        std::chrono::steady_clock::now() >= deadline)
+      return ready();
+    relax(spin);
+  }
+}
+
+}  // namespace detail
+
+/**
+ * Spin on the queue index without backing off, lowest latency but the
+ * consumer core is fully busy. Meant for isolated cores
+ */
+struct BusySpinWait {
+  template <typename Ready>
+  bool Wait(const Ready &ready, const std::chrono::nanoseconds timeout) {
+    return detail::SpinUntil(ready, timeout, [](uint32_t) {});
+  }
+
+  void Notify() noexcept {}
+};
+
+/**
+ * Spin with a pause instruction between polls, keeps the sibling hyper
+ * thread and the memory bus quieter at a small latency cost
+ */
+struct PauseSpinWait {
+  template <typename Ready>
+  bool Wait(const Ready &ready, const std::chrono::nanoseconds timeout) {
+    return detail::SpinUntil(ready, timeout, [](uint32_t) { CpuRelax(); });
+  }
+
+  void Notify() noexcept {}
+};
+
+/**
+ * Spin with pause for SPIN_COUNT polls, then yield the core to the scheduler
+ * between polls
+ */
+template <uint32_t SPIN_COUNT = 1 << 10>
+struct SpinYieldWaitT {
+  template <typename Ready>
+  bool Wait(const Ready &ready, const std::chrono::nanoseconds timeout) {
+    return detail::SpinUntil(ready, timeout, [](uint32_t spin) {
+      if (spin < SPIN_COUNT)
+        CpuRelax();
+      else
+        std::this_thread::yield();
+    });
+  }
+
+  void Notify() noexcept {}
+};
+
+using SpinYieldWait = SpinYieldWaitT<>;
+
+/**
+ * Spin for SPIN_COUNT polls, then park the consumer on a futex. The producer
+ * only pays for a wake syscall when the consumer announced it is parked.
+ * SHARED selects a futex that also wakes waiters in other processes mapping
+ * the same memory
+ */
+template <uint32_t SPIN_COUNT = 1 << 10, bool SHARED = false>
+class FutexWaitT {
+ public:
+  static constexpr bool PROCESS_SHARED = SHARED;
+
+  template <typename Ready>
+  bool Wait(const Ready &ready, const std::chrono::nanoseconds timeout) {
+    for (uint32_t spin = 0; spin < SPIN_COUNT; ++spin) {
+      if (ready()) return true;
+      CpuRelax();
+    }
+
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (true) {
+      const auto seq = seq_.load(std::memory_order_acquire);
+
+      // announce the park before the final check, pairs with the fence in
+      // Notify so either the producer sees the flag or we see the data
+      parked_.store(1, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      if (ready()) {
+        parked_.store(0, std::memory_order_relaxed);
+        return true;
+      }
+
+      const auto remaining = deadline - std::chrono::steady_clock::now();
+      if (remaining <= std::chrono::nanoseconds::zero()) {
+        parked_.store(0, std::memory_order_relaxed);
+        return ready();
+      }
+
+      Park(seq, remaining);
+      parked_.store(0, std::memory_order_relaxed);
+      if (ready()) return true;
+    }
+  }
+
+  void Notify() noexcept {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (parked_.load(std::memory_order_relaxed)) [[unlikely]] {
+      seq_.fetch_add(1, std::memory_order_release);
+      syscall(SYS_futex, &seq_, WAKE_OP, 1, nullptr, nullptr, 0);
+    }
+  }
+
+ private:
+  void Park(const uint32_t seq,
+            const std::chrono::nanoseconds remaining) noexcept {
+    const auto secs =
+        std::chrono::duration_cast<std::chrono::seconds>(remaining);
+    struct timespec ts;
+    ts.tv_sec = secs.count();
+    ts.tv_nsec = (remaining - secs).count();
+
+    // returns early on wake, value change, signal or timeout, the caller
+    // re-checks the queue in every case
+    syscall(SYS_futex, &seq_, WAIT_OP, seq, &ts, nullptr, 0);
+  }
+
+ private:
+  static constexpr int WAIT_OP = SHARED ? FUTEX_WAIT : FUTEX_WAIT_PRIVATE;
+  static constexpr int WAKE_OP = SHARED ? FUTEX_WAKE : FUTEX_WAKE_PRIVATE;
+
+  static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t),
+                "futex word must be a plain 32-bit integer");
+
+  std::atomic<uint32_t> seq_{0};
+  std::atomic<uint32_t> parked_{0};
+};
+
+using FutexWait = FutexWaitT<>;
+using SharedFutexWait = FutexWaitT<1 << 10, true>;
+
+namespace detail {
+
+template <typename WaitStrategy, typename = void>
+struct IsProcessShared : std::is_empty<WaitStrategy> {};
+
+template <typename WaitStrategy>
+struct IsProcessShared<WaitStrategy,
+                       std::void_t<decltype(WaitStrategy::PROCESS_SHARED)>>
+    : std::bool_constant<WaitStrategy::PROCESS_SHARED> {};
+
+}  // namespace detail
+
+}  // namespace hermes::container
@@ -0,0 +1,148 @@
+#pragma once
+
+#include <cstdint>
+#include <type_traits>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define HERMES_IO_X86 1
+#include <immintrin.h>
+#endif
+
+namespace hermes::io::detail {
+
+inline bool IsDigit(char c) noexcept {
+  return static_cast<unsigned char>(c - '0') < 10;
+}
+
+inline bool IsSpace(char c) noexcept {
+  return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+// Number of bytes in a vector digit run
+constexpr int SIMD_DIGITS = 16;
+
+// Parse the decimal digit run at ptr into value with one multiply-add per
+// digit, returns its length. Reads up to end only
+inline int ParseDigitsScalar(const char *ptr, const char *end,
+                             uint64_t &value) noexcept {
+  const char *begin = ptr;
+  uint64_t ret = 0;
+  while (ptr != end && IsDigit(*ptr)) ret = ret * 10 + (*ptr++ - '0');
+  value = ret;
+  return ptr - begin;
+}
+
+#ifdef HERMES_IO_X86
+
+inline bool HasSimdDigits() noexcept {
+  static const bool supported = __builtin_cpu_supports("sse4.2");
+  return supported;
+}
+
+// Find the end of the digit run in the SIMD_DIGITS bytes at ptr with a
+// vector compare and convert it in four multiply-add steps. Returns the run
+// length, a run of SIMD_DIGITS may go on past the vector. ptr must have
+// SIMD_DIGITS readable bytes
+__attribute__((target("sse4.2"))) inline int ParseDigitsSimd(
+    const char *ptr, uint64_t &value) noexcept {
+  const __m128i chunk =
+      _mm_loadu_si128(reinterpret_cast<const __m128i *>(ptr));
+
+  // bytes c - '0' <= 9 are digits, everything else wraps above 9
+  const __m128i digits = _mm_sub_epi8(chunk, _mm_set1_epi8('0'));
+  const __m128i is_digit =
+      _mm_cmpeq_epi8(_mm_min_epu8(digits, _mm_set1_epi8(9)), digits);
+  const uint32_t mask = _mm_movemask_epi8(is_digit);
+  const int len = __builtin_ctz(~mask);
+
+  // right align the run so the last digit has weight 1, shuffle indices
+  // with the high bit set zero the leading bytes
+  alignas(16) static constexpr int8_t SHIFT[2 * SIMD_DIGITS] = {
+      -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+      0,  1,  2,  3,  4,  5,  6,  7,  8,  9,  10, 11, 12, 13, 14, 15};
+  const __m128i shuffle =
+      _mm_loadu_si128(reinterpret_cast<const __m128i *>(SHIFT + len));
+  const __m128i aligned = _mm_shuffle_epi8(digits, shuffle);
+
+  // 16 digits -> 8 pairs -> 4 quads -> 2 groups of 8 digits
+  const __m128i pairs = _mm_maddubs_epi16(
+      aligned, _mm_setr_epi8(10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1,
+                             10, 1));
+  const __m128i quads = _mm_madd_epi16(
+      pairs, _mm_setr_epi16(100, 1, 100, 1, 100, 1, 100, 1));
+  const __m128i packed = _mm_packus_epi32(quads, quads);
+  const __m128i octets = _mm_madd_epi16(
+      packed, _mm_setr_epi16(10000, 1, 10000, 1, 10000, 1, 10000, 1));
+
+  const uint64_t high = static_cast<uint32_t>(_mm_cvtsi128_si32(octets));
+  const uint64_t low = static_cast<uint32_t>(_mm_extract_epi32(octets, 1));
+  value = high * 100000000 + low;
+  return len;
+}
+
+#else
+
+inline bool HasSimdDigits() noexcept { return false; }
+
+inline int ParseDigitsSimd(const char *ptr, uint64_t &value) noexcept {
+  return ParseDigitsScalar(ptr, ptr + SIMD_DIGITS, value);
+}
+
+#endif
+
+// Parse the digit run at ptr, the first SIMD_DIGITS bytes with the vector
+// parser and the rest of a longer run one character at a time. Returns the
+// run length or -1 when the run reaches end and may go on past it. ptr must
+// have SIMD_DIGITS readable bytes before end
+inline int ParseDigitRun(const char *ptr, const char *end,
+                         uint64_t &value) noexcept {
+  const int len = ParseDigitsSimd(ptr, value);
+  if (len < SIMD_DIGITS) [[likely]]
+    return len;
+
+  const char *curr = ptr + len;
+  while (curr != end && IsDigit(*curr)) value = value * 10 + (*curr++ - '0');
+  return curr == end ? -1 : curr - ptr;
+}
+
+// Apply a parsed sign in the unsigned type, negation wraps so the most
+// negative value parses too
+template <typename T>
+inline T ApplySign(const std::make_unsigned_t<T> value,
+                   const bool negative) noexcept {
+  return static_cast<T>(negative ? std::make_unsigned_t<T>(0) - value : value);
+}
+
+// Parse the integer at curr, a minus sign is only taken for signed types.
+// Like every fast reader, a value is followed by one separator character and
+// the whitespace after it is skipped, so "1  2" reads 1, 2 and "1,,2" reads
+// 1, 0, 2. Returns the bytes taken by its sign, digits, separator and
+// whitespace, or -1 when they reach end and may go on past it. This is the
+// parsing core shared by the sequential and parallel readers
+template <typename T>
+inline int ParseInteger(const char *curr, const char *end, const bool simd,
+                        T &value) noexcept {
+  if (curr >= end) return -1;
+
+  const bool negative = std::is_signed_v<T> && *curr == '-';
+  const char *digits = curr + negative;
+
+  uint64_t ret;
+  int len;
+  if (simd && end - digits >= SIMD_DIGITS) [[likely]] {
+    len = ParseDigitRun(digits, end, ret);
+  } else {
+    len = ParseDigitsScalar(digits, end, ret);
+    if (digits + len == end) len = -1;
+  }
+  if (len < 0) return -1;
+
+  const char *next = digits + len + 1;
+  while (next != end && IsSpace(*next)) ++next;
+  if (next == end) return -1;
+
+  value = ApplySign<T>(static_cast<std::make_unsigned_t<T>>(ret), negative);
+  return next - curr;
+}
+
+}  // namespace hermes::io::detail
@@ -7,95 +7,358 @@
 #include <sys/stat.h>
 #include <unistd.h>
 
+#include <algorithm>
+#include <cstdint>
 #include <cstdio>
 #include <cstring>
+#include <string>
 #include <type_traits>
 
+#include "hermes/container/stl_vector.h"
+#include "hermes/io/digits.h"
+#include "hermes/io/floats.h"
+
 namespace hermes::io {
 
-template <typename T, int MAX_BUFFER_SIZE = 1 << 13,
-          typename = std::enable_if_t<std::is_integral<T>::value>>
-class IntegralFastIO {
+/**
+ * How the fast readers map their file
+ */
+struct FastIOOptions {
+  // Files up to this size are mapped whole once, larger ones window by
+  // window of MAX_BUFFER_SIZE bytes
+  size_t max_mapping_size{size_t(1) << 32};
+
+  // Fault the whole mapping in with MAP_POPULATE
+  bool populate{true};
+
+  // Ask for transparent huge pages on the whole mapping, only effective
+  // when the file system supports them for the page cache
+  bool huge_pages{false};
+};
+
+namespace detail {
+
+/**
+ * Maps a file for the fast readers, NextChar hands out one character at a
+ * time. Files up to FastIOOptions::max_mapping_size are mapped whole once
+ * and parsed straight through, larger ones are remapped window by window
+ */
+template <int MAX_BUFFER_SIZE>
+class FastIOWindow {
+ public:
+  FastIOWindow(const FastIOWindow &_) = delete;
+  FastIOWindow &operator=(const FastIOWindow &_) = delete;
+
+  FastIOWindow() {}
+
+  ~FastIOWindow() { Close(); }
+
  public:
-  void Init(const char *path) { Init(open(path, O_RDONLY)); }
+  // The reader owns and closes the file it opens from path
+  void Init(const char *path, const FastIOOptions &options = {}) {
+    Init(open(path, O_RDONLY), options);
+    owns_fd_ = true;
+  }
+
+  void Init(const int fd, const FastIOOptions &options = {}) noexcept {
+    Close();
 
-  void Init(const int fd) noexcept {
     fd_ = fd;
     file_offset_ = 0;
+    options_ = options;
 
     struct stat stat_buf;
     CHECK(fstat(fd, &stat_buf) == 0)
-        << "Failed to init IntegralFastIO, could not get file size";
-    fstat(fd, &stat_buf);
+        << "Failed to init FastIO, could not get file size";
     file_size_ = stat_buf.st_size;
 
-    buffer_base_ = new char[MAX_BUFFER_SIZE + sysconf(_SC_PAGESIZE)];
+    whole_file_ = file_size_ <= options.max_mapping_size;
+    window_size_ = whole_file_ ? file_size_ : MAX_BUFFER_SIZE;
+    CHECK(whole_file_ || MAX_BUFFER_SIZE % sysconf(_SC_PAGESIZE) == 0)
+        << "FastIO window of " << MAX_BUFFER_SIZE
+        << " bytes is not a multiple of the page size";
 
     ReadToBuffer();
 
     is_good_ = end_ != begin_;
 
     LOG_FIRST_N(INFO, 100) << "Initilized FastIO reader with file size = "
-                           << file_size_;
+                           << file_size_ << ", whole file mapping = "
+                           << whole_file_;
   }
 
   inline bool IsGood() const noexcept { return is_good_; }
 
-  T ReadOne() {
-    T ret = 0;
-
-    char c = NextChar();
-    while (IsDigit(c)) {
-      ret = ret * 10 + (c - '0');
-      c = NextChar();
-    }
+  void Close() noexcept {
+    if (buffer_ != &sentinel_) munmap(buffer_, end_);
+    if (owns_fd_) close(fd_);
 
-    return ret;
+    buffer_ = &sentinel_;
+    begin_ = end_ = 0;
+    fd_ = -1;
+    owns_fd_ = false;
+    is_good_ = false;
   }
 
- public:
-  static inline bool IsDigit(char c) noexcept {
-    return static_cast<unsigned char>(c - '0') < 10;
+ protected:
+  // Characters left in the window or the rest of the file
+  inline bool HasData() const noexcept {
+    return begin_ < end_ || file_offset_ + end_ < file_size_;
   }
 
- private:
   inline char NextChar() {
     if (begin_ >= end_) [[unlikely]]
       ReadToBuffer();
     return buffer_[begin_++];
   }
 
+  // Next character without taking it, '\0' at the end of the file
+  inline char PeekChar() {
+    if (begin_ >= end_) [[unlikely]]
+      ReadToBuffer();
+    return buffer_[begin_];
+  }
+
   void ReadToBuffer() {
-    munmap(buffer_, end_);
+    if (buffer_ != &sentinel_) munmap(buffer_, end_);
     file_offset_ += end_;
 
     begin_ = end_ = 0;
-    buffer_ = buffer_base_;
-    *buffer_ = '\0';
+    buffer_ = &sentinel_;
+
+    const auto read_size = std::min(file_size_ - file_offset_, window_size_);
+    if (read_size == 0) {
+      is_good_ = false;
+      return;
+    }
 
-    const auto read_size =
-        std::min(file_size_ - file_offset_, size_t(MAX_BUFFER_SIZE));
-    const auto addr = mmap(buffer_base_, read_size, PROT_READ, MAP_PRIVATE, fd_,
-                           file_offset_);
+    int flags = MAP_PRIVATE;
+    if (whole_file_ && options_.populate) flags |= MAP_POPULATE;
+    const auto addr =
+        mmap(nullptr, read_size, PROT_READ, flags, fd_, file_offset_);
 
-    if (addr != (void *)-1) [[likely]] {
+    if (addr != MAP_FAILED) [[likely]] {
       buffer_ = reinterpret_cast<char *>(addr);
       end_ = read_size;
+
+      if (whole_file_) {
+        madvise(buffer_, read_size, MADV_SEQUENTIAL);
+        if (options_.huge_pages) madvise(buffer_, read_size, MADV_HUGEPAGE);
+      }
     }
 
     is_good_ = begin_ != end_;
   }
 
- private:
+ protected:
   bool is_good_{false};
-  int begin_{0}, end_{0};
+  bool whole_file_{false};
+  // 64 bit so a whole file mapping can exceed 2 GB
+  int64_t begin_{0}, end_{0};
 
-  char *buffer_base_{0};
-  char *buffer_{0};
+  // parsing is bounded by end_, past the end of the file NextChar reads
+  // this '\0' instead of a mapping
+  char sentinel_{'\0'};
+  char *buffer_{&sentinel_};
 
   size_t file_size_{0};
   size_t file_offset_{0};
+  size_t window_size_{MAX_BUFFER_SIZE};
   int fd_{-1};
+  bool owns_fd_{false};
+
+  FastIOOptions options_;
+};
+
+}  // namespace detail
+
+/**
+ * Reader of separated integers from a file, see FastIOOptions for how it is
+ * mapped. Signed types accept a leading minus sign. Separators follow the
+ * rule of detail::ParseInteger, shared with FloatFastIO
+ *
+ * ReadOne parses the digit run of a value with a vector compare and a few
+ * multiply-add steps when the CPU supports it and the run ends inside the
+ * current window, otherwise one character at a time
+ */
+template <typename T, int MAX_BUFFER_SIZE = 1 << 13,
+          typename = std::enable_if_t<std::is_integral<T>::value>>
+class IntegralFastIO : public detail::FastIOWindow<MAX_BUFFER_SIZE> {
+  using Window = detail::FastIOWindow<MAX_BUFFER_SIZE>;
+  using Unsigned = std::make_unsigned_t<T>;
+
+ public:
+  void Init(const char *path, const FastIOOptions &options = {}) {
+    simd_ = detail::HasSimdDigits();
+    Window::Init(path, options);
+  }
+
+  void Init(const int fd, const FastIOOptions &options = {}) noexcept {
+    simd_ = detail::HasSimdDigits();
+    Window::Init(fd, options);
+  }
+
+  T ReadOne() {
+    T value;
+    const int len =
+        detail::ParseInteger(buffer_ + begin_, buffer_ + end_, simd_, value);
+    if (len >= 0) [[likely]] {
+      begin_ += len;
+      return value;
+    }
+
+    return ReadOneScalar();
+  }
+
+  // Parse up to n values into out in a tight loop over the mapping, returns
+  // how many were read, fewer than n only at the end of the file
+  size_t ReadMany(T *out, const size_t n) {
+    size_t count = 0;
+    while (count < n) {
+      const char *curr = buffer_ + begin_;
+      const char *const end = buffer_ + end_;
+      while (count < n) {
+        const int len = detail::ParseInteger(curr, end, simd_, out[count]);
+        if (len < 0) break;
+        curr += len;
+        count += 1;
+      }
+      begin_ = curr - buffer_;
+
+      if (count == n) break;
+      if (!HasData()) {
+        is_good_ = false;
+        break;
+      }
+
+      // a value crossing the window
+      out[count++] = ReadOneScalar();
+    }
+    return count;
+  }
+
+  // Append every remaining value to out, returns how many were read
+  size_t ReadAll(container::Vector<T> &out) {
+    constexpr size_t MIN_BLOCK_SIZE = 1 << 12;
+
+    size_t count = 0;
+    while (HasData()) {
+      const auto size = out.Size();
+      if (out.MaxSize() - size < MIN_BLOCK_SIZE)
+        out.Reserve(std::max(2 * out.MaxSize(), size + MIN_BLOCK_SIZE));
+
+      out.Resize(out.MaxSize());
+      const auto read = ReadMany(out.Data() + size, out.Size() - size);
+      out.Resize(size + read);
+      count += read;
+    }
+
+    is_good_ = false;
+    return count;
+  }
+
+  // Character at a time parsing, also used for runs crossing a window
+  T ReadOneScalar() {
+    Unsigned ret = 0;
+
+    char c = NextChar();
+    const bool negative = std::is_signed_v<T> && c == '-';
+    if (negative) c = NextChar();
+
+    while (IsDigit(c)) {
+      ret = ret * 10 + (c - '0');
+      c = NextChar();
+    }
+
+    // c was the separator, skip the whitespace after it
+    while (detail::IsSpace(PeekChar())) ++begin_;
+    return Sign(ret, negative);
+  }
+
+ public:
+  static inline bool IsDigit(char c) noexcept { return detail::IsDigit(c); }
+
+ private:
+  static inline T Sign(const Unsigned value, const bool negative) noexcept {
+    return detail::ApplySign<T>(value, negative);
+  }
+
+ private:
+  using Window::begin_;
+  using Window::buffer_;
+  using Window::end_;
+  using Window::HasData;
+  using Window::is_good_;
+  using Window::NextChar;
+  using Window::PeekChar;
+
+  bool simd_{false};
+};
+
+/**
+ * Reader of separated floating point numbers from a file, see FastIOOptions
+ * for how it is mapped. Values are correctly rounded like strtod
+ *
+ * Numbers up to 19 significant digits convert with exact floating point
+ * arithmetic or Eisel-Lemire, see floats.h. A number crossing a window is
+ * gathered character by character first
+ */
+template <typename T, int MAX_BUFFER_SIZE = 1 << 13,
+          typename = std::enable_if_t<std::is_floating_point<T>::value>>
+class FloatFastIO : public detail::FastIOWindow<MAX_BUFFER_SIZE> {
+  using Window = detail::FastIOWindow<MAX_BUFFER_SIZE>;
+
+ public:
+  T ReadOne() {
+    if (begin_ < end_) [[likely]] {
+      T value;
+      const int len =
+          detail::ParseFloat(buffer_ + begin_, buffer_ + end_, value);
+      if (len >= 0) [[likely]] {
+        begin_ += len;
+        SkipSeparator();
+        return value;
+      }
+    }
+
+    return ReadOneSlow();
+  }
+
+ private:
+  T ReadOneSlow() {
+    std::string token;
+    while (IsFloatChar(PeekChar())) token.push_back(buffer_[begin_++]);
+    SkipSeparator();
+
+    // terminated so the parser does not wait for more characters
+    token.push_back(' ');
+    T value = 0;
+    detail::ParseFloat(token.data(), token.data() + token.size(), value);
+    return value;
+  }
+
+  // Skip what is left of a token the parser stopped in, e.g. the "e" of
+  // "1e", then one separator character and the whitespace after it, the same
+  // rule as detail::ParseInteger. Taking that character keeps text that is
+  // not a number, e.g. "nan", from stalling the reader, each such character
+  // reads as 0
+  void SkipSeparator() {
+    while (IsFloatChar(PeekChar())) ++begin_;
+    // begin_ == end_ only past the end of the file
+    if (!detail::IsSpace(PeekChar()) && begin_ < end_) ++begin_;
+    while (detail::IsSpace(PeekChar())) ++begin_;
+  }
+
+  static inline bool IsFloatChar(char c) noexcept {
+    return detail::IsDigit(c) || c == '.' || c == '-' || c == '+' ||
+           c == 'e' || c == 'E';
+  }
+
+ private:
+  using Window::begin_;
+  using Window::buffer_;
+  using Window::end_;
+  using Window::PeekChar;
 };
 
 }  // namespace hermes::io
@@ -0,0 +1,243 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <type_traits>
+
+#include "hermes/io/digits.h"
+#include "hermes/io/power_of_five.h"
+
+namespace hermes::io::detail {
+
+template <typename T>
+struct FloatTraits;
+
+template <>
+struct FloatTraits<double> {
+  using Bits = uint64_t;
+
+  static constexpr int MANTISSA_BITS = 52;
+  static constexpr int MINIMUM_EXPONENT = -1023;
+  static constexpr int INFINITE_POWER = 0x7ff;
+  static constexpr int SIGN_SHIFT = 63;
+
+  // w * 10^q is exact in a double for w < 2^53 and |q| <= 22
+  static constexpr uint64_t MAX_EXACT_MANTISSA = uint64_t(1) << 53;
+  static constexpr int MAX_EXACT_POWER = 22;
+
+  // below or above these powers of ten any 19 digit value rounds to zero or
+  // infinity
+  static constexpr int SMALLEST_POWER_OF_TEN = -342;
+  static constexpr int LARGEST_POWER_OF_TEN = 308;
+
+  // only these powers can produce an exact halfway case
+  static constexpr int MIN_EXPONENT_ROUND_TO_EVEN = -4;
+  static constexpr int MAX_EXPONENT_ROUND_TO_EVEN = 23;
+
+  static double Parse(const char *str) { return std::strtod(str, nullptr); }
+};
+
+template <>
+struct FloatTraits<float> {
+  using Bits = uint32_t;
+
+  static constexpr int MANTISSA_BITS = 23;
+  static constexpr int MINIMUM_EXPONENT = -127;
+  static constexpr int INFINITE_POWER = 0xff;
+  static constexpr int SIGN_SHIFT = 31;
+
+  static constexpr uint64_t MAX_EXACT_MANTISSA = uint64_t(1) << 24;
+  static constexpr int MAX_EXACT_POWER = 10;
+
+  static constexpr int SMALLEST_POWER_OF_TEN = -64;
+  static constexpr int LARGEST_POWER_OF_TEN = 38;
+
+  static constexpr int MIN_EXPONENT_ROUND_TO_EVEN = -17;
+  static constexpr int MAX_EXPONENT_ROUND_TO_EVEN = 10;
+
+  static float Parse(const char *str) { return std::strtof(str, nullptr); }
+};
+
+// Significant digits that always fit a uint64_t mantissa
+constexpr int MAX_MANTISSA_DIGITS = 19;
+
+inline constexpr double EXACT_POWER_OF_TEN[] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+// Correctly rounded w * 10^q with one or two 64x128 bit multiplications by
+// a truncated power of five, Eisel-Lemire. Exact for every 64 bit w and q
+template <typename T>
+T EiselLemire(const int64_t q, uint64_t w, const bool negative) noexcept {
+  using Traits = FloatTraits<T>;
+  using Bits = typename Traits::Bits;
+
+  uint64_t mantissa = 0;
+  int64_t power2 = 0;
+
+  if (w == 0 || q < Traits::SMALLEST_POWER_OF_TEN) {
+    // zero
+  } else if (q > Traits::LARGEST_POWER_OF_TEN) {
+    power2 = Traits::INFINITE_POWER;
+  } else {
+    const int lz = __builtin_clzll(w);
+    w <<= lz;
+
+    // 64 x 128 bit product, the low half of the power only matters when the
+    // bits below the mantissa precision are all ones
+    const auto index = 2 * (q - SMALLEST_POWER_OF_FIVE);
+    auto product =
+        static_cast<unsigned __int128>(w) * POWER_OF_FIVE_128[index];
+    uint64_t high = product >> 64;
+    uint64_t low = product;
+
+    constexpr uint64_t PRECISION_MASK =
+        ~uint64_t(0) >> (Traits::MANTISSA_BITS + 3);
+    if ((high & PRECISION_MASK) == PRECISION_MASK) {
+      const auto second =
+          static_cast<unsigned __int128>(w) * POWER_OF_FIVE_128[index + 1];
+      const uint64_t second_high = second >> 64;
+      low += second_high;
+      if (second_high > low) high += 1;
+    }
+
+    const int upper_bit = high >> 63;
+    const int shift = upper_bit + 64 - Traits::MANTISSA_BITS - 3;
+    mantissa = high >> shift;
+    // floor(q * log2(10)) + 63
+    power2 = (((152170 + 65536) * q) >> 16) + 63 + upper_bit - lz -
+             Traits::MINIMUM_EXPONENT;
+
+    if (power2 <= 0) {
+      // subnormal, or zero when shifted out entirely
+      if (-power2 + 1 >= 64) {
+        mantissa = 0;
+        power2 = 0;
+      } else {
+        mantissa >>= -power2 + 1;
+        mantissa += mantissa & 1;
+        mantissa >>= 1;
+        power2 = mantissa < (uint64_t(1) << Traits::MANTISSA_BITS) ? 0 : 1;
+      }
+    } else {
+      // round half up, except an exact halfway case rounds to even
+      if (low <= 1 && q >= Traits::MIN_EXPONENT_ROUND_TO_EVEN &&
+          q <= Traits::MAX_EXPONENT_ROUND_TO_EVEN && (mantissa & 3) == 1 &&
+          (mantissa << shift) == high)
+        mantissa &= ~uint64_t(1);
+
+      mantissa += mantissa & 1;
+      mantissa >>= 1;
+      if (mantissa >= (uint64_t(2) << Traits::MANTISSA_BITS)) {
+        mantissa = uint64_t(1) << Traits::MANTISSA_BITS;
+        power2 += 1;
+      }
+      mantissa &= ~(uint64_t(1) << Traits::MANTISSA_BITS);
+
+      if (power2 >= Traits::INFINITE_POWER) {
+        mantissa = 0;
+        power2 = Traits::INFINITE_POWER;
+      }
+    }
+  }
+
+  const Bits bits = static_cast<Bits>(mantissa) |
+                    (static_cast<Bits>(power2) << Traits::MANTISSA_BITS) |
+                    (static_cast<Bits>(negative) << Traits::SIGN_SHIFT);
+  T ret;
+  std::memcpy(&ret, &bits, sizeof(T));
+  return ret;
+}
+
+// Correctly rounded w * 10^q, exact floating point arithmetic when w and
+// 10^|q| are both exact, Eisel-Lemire otherwise
+template <typename T>
+T ToFloat(const int64_t q, const uint64_t w, const bool negative) noexcept {
+  using Traits = FloatTraits<T>;
+
+  if (w <= Traits::MAX_EXACT_MANTISSA && q >= -Traits::MAX_EXACT_POWER &&
+      q <= Traits::MAX_EXACT_POWER) {
+    T ret = static_cast<T>(w);
+    if (q < 0)
+      ret /= static_cast<T>(EXACT_POWER_OF_TEN[-q]);
+    else
+      ret *= static_cast<T>(EXACT_POWER_OF_TEN[q]);
+    return negative ? -ret : ret;
+  }
+
+  return EiselLemire<T>(q, w, negative);
+}
+
+// Parse a decimal floating point number [-+]digits[.digits][(e|E)[-+]digits]
+// at ptr into value, returns its length or -1 when the number reaches end
+// and may go on past it. Text without digits parses as 0. More than 19
+// significant digits fall back to strtod, exact but slow
+template <typename T>
+int ParseFloat(const char *ptr, const char *end, T &value) {
+  const char *curr = ptr;
+
+  const bool negative = curr != end && *curr == '-';
+  if (curr != end && (*curr == '-' || *curr == '+')) ++curr;
+
+  uint64_t w = 0;
+  int64_t exponent = 0;
+  int digits = 0;
+
+  const char *mantissa_begin = curr;
+  while (curr != end && IsDigit(*curr)) {
+    w = w * 10 + (*curr++ - '0');
+    digits += 1;
+  }
+  if (curr != end && *curr == '.') {
+    ++curr;
+    const char *fraction_begin = curr;
+    while (curr != end && IsDigit(*curr)) w = w * 10 + (*curr++ - '0');
+    exponent = fraction_begin - curr;
+    digits += curr - fraction_begin;
+  }
+  const char *mantissa_end = curr;
+
+  // the exponent is only taken when it has digits, "1e" parses as 1
+  if (curr != end && (*curr == 'e' || *curr == 'E')) {
+    const char *exp_curr = curr + 1;
+    const bool exp_negative = exp_curr != end && *exp_curr == '-';
+    if (exp_curr != end && (*exp_curr == '-' || *exp_curr == '+')) ++exp_curr;
+
+    if (exp_curr != end && IsDigit(*exp_curr)) {
+      int64_t exp_value = 0;
+      while (exp_curr != end && IsDigit(*exp_curr)) {
+        // any larger exponent already rounds to zero or infinity
+        if (exp_value < 0x10000) exp_value = exp_value * 10 + (*exp_curr - '0');
+        ++exp_curr;
+      }
+      exponent += exp_negative ? -exp_value : exp_value;
+      curr = exp_curr;
+    } else if (exp_curr == end) {
+      return -1;
+    }
+  }
+
+  if (curr == end) return -1;
+
+  if (digits > MAX_MANTISSA_DIGITS) [[unlikely]] {
+    // leading zeros do not count, "0.000123" has 3 significant digits
+    auto *first = mantissa_begin;
+    while (first != mantissa_end && (*first == '0' || *first == '.')) ++first;
+
+    int significant = 0;
+    for (auto *c = first; c != mantissa_end; ++c) significant += IsDigit(*c);
+
+    if (significant > MAX_MANTISSA_DIGITS) {
+      value = FloatTraits<T>::Parse(std::string(ptr, curr).c_str());
+      return curr - ptr;
+    }
+  }
+
+  value = ToFloat<T>(exponent, w, negative);
+  return curr - ptr;
+}
+
+}  // namespace hermes::io::detail
@@ -0,0 +1,193 @@
+#pragma once
+
+#include <fcntl.h>
+#include <glog/logging.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "hermes/container/stl_vector.h"
+#include "hermes/io/digits.h"
+#include "hermes/io/fastio.h"
+
+namespace hermes::io {
+
+/**
+ * Parallel reader of separated integers from a file
+ *
+ * The file is always mapped whole, whatever its size, and split into one
+ * chunk per thread, each chunk boundary moved forward to the start of a
+ * value. Every thread counts the values of its chunk, then parses them with
+ * the same core as IntegralFastIO::ReadMany straight into their final
+ * place, so both read the same values in the same order
+ */
+template <typename T,
+          typename = std::enable_if_t<std::is_integral<T>::value>>
+class ParallelFastIO {
+ public:
+  ParallelFastIO(const ParallelFastIO &_) = delete;
+  ParallelFastIO &operator=(const ParallelFastIO &_) = delete;
+
+  ParallelFastIO() {}
+
+  ~ParallelFastIO() { Close(); }
+
+ public:
+  // Map the whole file at path, only FastIOOptions::huge_pages is used. The
+  // threads need every chunk at once, so max_mapping_size does not apply,
+  // and the pages are faulted in by the threads in parallel, not populated
+  void Init(const char *path, const FastIOOptions &options = {}) noexcept {
+    Close();
+
+    fd_ = open(path, O_RDONLY);
+    CHECK(fd_ != -1) << "Failed to init ParallelFastIO, could not open file";
+
+    struct stat stat_buf;
+    CHECK(fstat(fd_, &stat_buf) == 0)
+        << "Failed to init ParallelFastIO, could not get file size";
+    size_ = stat_buf.st_size;
+
+    if (size_ > 0) {
+      data_ = static_cast<char *>(
+          mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd_, 0));
+      CHECK(data_ != MAP_FAILED) << "Failed to map file of " << size_
+                                 << " bytes";
+      madvise(data_, size_, MADV_SEQUENTIAL);
+      if (options.huge_pages) madvise(data_, size_, MADV_HUGEPAGE);
+    }
+
+    simd_ = detail::HasSimdDigits();
+  }
+
+  void Close() noexcept {
+    if (data_ != nullptr) munmap(data_, size_);
+    if (fd_ != -1) close(fd_);
+
+    data_ = nullptr;
+    size_ = 0;
+    fd_ = -1;
+  }
+
+  // Parse the file on thread_count threads, returns the values of every
+  // chunk in file order
+  std::vector<container::Vector<T>> ReadChunks(
+      const size_t thread_count = std::thread::hardware_concurrency()) {
+    const auto bounds = SplitChunks(std::max<size_t>(thread_count, 1));
+
+    // sized once, Vector elements must not be copied by a reallocation
+    std::vector<container::Vector<T>> chunks(bounds.size() - 1);
+    RunParallel(chunks.size(), [&](const size_t i) {
+      const char *begin = data_ + bounds[i], *end = data_ + bounds[i + 1];
+      chunks[i].Resize(CountChunk(begin, end));
+      ParseChunk(begin, end, chunks[i].Data());
+    });
+    return chunks;
+  }
+
+  // Parse the file on thread_count threads and append every value to out in
+  // file order, returns how many were read. out grows once to its final size
+  // and every thread parses into its own range of it, nothing else holds
+  // the values
+  size_t ReadAll(
+      container::Vector<T> &out,
+      const size_t thread_count = std::thread::hardware_concurrency()) {
+    const auto bounds = SplitChunks(std::max<size_t>(thread_count, 1));
+    const auto chunk_count = bounds.size() - 1;
+
+    std::vector<size_t> offsets(chunk_count + 1, out.Size());
+    RunParallel(chunk_count, [&](const size_t i) {
+      offsets[i + 1] = CountChunk(data_ + bounds[i], data_ + bounds[i + 1]);
+    });
+    for (size_t i = 0; i < chunk_count; ++i) offsets[i + 1] += offsets[i];
+
+    out.Resize(offsets.back());
+    RunParallel(chunk_count, [&](const size_t i) {
+      ParseChunk(data_ + bounds[i], data_ + bounds[i + 1],
+                 out.Data() + offsets[i]);
+    });
+    return offsets.back() - offsets.front();
+  }
+
+  size_t FileSize() const noexcept { return size_; }
+
+ private:
+  // Chunk offsets, chunk i is [bounds[i], bounds[i + 1])
+  std::vector<size_t> SplitChunks(const size_t count) const noexcept {
+    std::vector<size_t> bounds{0};
+    for (size_t i = 1; i < count; ++i) {
+      auto bound = std::max(size_ * i / count, bounds.back());
+      while (bound < size_ && !IsValueStart(bound)) ++bound;
+      bounds.push_back(bound);
+    }
+    bounds.push_back(size_);
+    return bounds;
+  }
+
+  // A value starts right after every separator, a minus sign of a signed
+  // type belongs to the value that follows it and whitespace after a
+  // separator is skipped, see detail::ParseInteger
+  bool IsValueStart(const size_t offset) const noexcept {
+    if (offset == 0) return true;
+
+    const char prev = data_[offset - 1];
+    return !detail::IsDigit(prev) && !(std::is_signed_v<T> && prev == '-') &&
+           !detail::IsSpace(data_[offset]);
+  }
+
+  // Number of values ParseChunk reads from [curr, end), every value takes
+  // its sign, its digits, one separator and the whitespace after it
+  static size_t CountChunk(const char *curr, const char *end) noexcept {
+    size_t count = 0;
+    while (curr < end) {
+      if (std::is_signed_v<T> && *curr == '-') ++curr;
+      while (curr < end && detail::IsDigit(*curr)) ++curr;
+      ++curr;
+      while (curr < end && detail::IsSpace(*curr)) ++curr;
+      count += 1;
+    }
+    return count;
+  }
+
+  // Parse every value of [curr, end) into out, which has room for
+  // CountChunk of them
+  void ParseChunk(const char *curr, const char *end, T *out) const {
+    while (curr < end) {
+      const int len = detail::ParseInteger(curr, end, simd_, *out);
+      if (len < 0) [[unlikely]] {
+        // the last value of the chunk, its separator lies at or past end so
+        // ParseInteger gives up on it. Taken once per chunk, every chunk
+        // boundary depends on it
+        const bool negative = std::is_signed_v<T> && *curr == '-';
+        uint64_t ret;
+        detail::ParseDigitsScalar(curr + negative, end, ret);
+        *out = detail::ApplySign<T>(static_cast<std::make_unsigned_t<T>>(ret),
+                                    negative);
+        break;
+      }
+
+      out += 1;
+      curr += len;
+    }
+  }
+
+  template <typename Functor>
+  static void RunParallel(const size_t count, const Functor &functor) {
+    std::vector<std::thread> threads;
+    threads.reserve(count);
+    for (size_t i = 0; i < count; ++i) threads.emplace_back(functor, i);
+    for (auto &thread : threads) thread.join();
+  }
+
+ private:
+  int fd_{-1};
+  size_t size_{0};
+  char *data_{nullptr};
+  bool simd_{false};
+};
+
+}  // namespace hermes::io
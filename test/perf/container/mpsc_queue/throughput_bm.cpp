@@ -0,0 +1,96 @@
+#include <benchmark/benchmark.h>
+
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "hermes/container/mpsc_queue.h"
+#include "hermes/container/spsc_queue.h"
+#include "test/perf/container/spsc_queue/bm_util.h"
+
+namespace bm = benchmark;
+
+using hermes::perf::PinThread;
+
+namespace {
+
+constexpr int CONSUMER_CPU = 0;
+constexpr uint32_t QUEUE_SIZE = 1 << 16;
+constexpr int64_t ITEMS_PER_PRODUCER = 1 << 20;
+
+}  // namespace
+
+// N producers fan in to one consumer through a single MpscQueue
+static void hermesMpscThroughputBM(bm::State &state) {
+  const int producer_count = state.range(0);
+  const int64_t total = producer_count * ITEMS_PER_PRODUCER;
+  auto queue =
+      std::make_unique<hermes::container::MpscQueue<int64_t, QUEUE_SIZE>>();
+
+  PinThread(CONSUMER_CPU);
+  for (auto _ : state) {
+    std::vector<std::thread> producers;
+    for (int p = 0; p < producer_count; ++p) {
+      producers.emplace_back([&, p]() {
+        PinThread(CONSUMER_CPU + 1 + p);
+        for (int64_t i = 0; i < ITEMS_PER_PRODUCER; ++i)
+          while (!queue->Write(i)) {
+          }
+      });
+    }
+
+    int64_t received = 0, sum = 0;
+    while (received < total)
+      received += queue->ConsumeAll([&](int64_t &v) { sum += v; });
+    bm::DoNotOptimize(sum);
+
+    for (auto &th : producers) th.join();
+  }
+
+  state.SetItemsProcessed(state.iterations() * total);
+}
+
+// Baseline: one SpscQueue per producer polled round robin by the consumer
+static void hermesSpscFanInThroughputBM(bm::State &state) {
+  using Queue = hermes::container::SpscQueue<int64_t, QUEUE_SIZE>;
+
+  const int producer_count = state.range(0);
+  const int64_t total = producer_count * ITEMS_PER_PRODUCER;
+  std::vector<std::unique_ptr<Queue>> queues;
+  for (int p = 0; p < producer_count; ++p)
+    queues.push_back(std::make_unique<Queue>());
+
+  PinThread(CONSUMER_CPU);
+  for (auto _ : state) {
+    std::vector<std::thread> producers;
+    for (int p = 0; p < producer_count; ++p) {
+      producers.emplace_back([&, p]() {
+        PinThread(CONSUMER_CPU + 1 + p);
+        for (int64_t i = 0; i < ITEMS_PER_PRODUCER; ++i)
+          while (!queues[p]->Write(i)) {
+          }
+      });
+    }
+
+    int64_t received = 0, sum = 0;
+    while (received < total)
+      for (auto &queue : queues)
+        received += queue->ConsumeAll([&](int64_t &v) { sum += v; });
+    bm::DoNotOptimize(sum);
+
+    for (auto &th : producers) th.join();
+  }
+
+  state.SetItemsProcessed(state.iterations() * total);
+}
+
+BENCHMARK(hermesMpscThroughputBM)
+    ->RangeMultiplier(2)
+    ->Range(1, 8)
+    ->UseRealTime();
+BENCHMARK(hermesSpscFanInThroughputBM)
+    ->RangeMultiplier(2)
+    ->Range(1, 8)
+    ->UseRealTime();
+
+BENCHMARK_MAIN();
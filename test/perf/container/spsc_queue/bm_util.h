@@ -0,0 +1,63 @@
+#pragma once
+
+#include <pthread.h>
+#include <sched.h>
+
+#include <cstdint>
+#include <mutex>
+#include <queue>
+#include <thread>
+
+namespace hermes::perf {
+
+constexpr int PRODUCER_CPU = 0;
+constexpr int CONSUMER_CPU = 1;
+
+inline void PinThread(const int cpu) {
+  cpu_set_t cpuset;
+  CPU_ZERO(&cpuset);
+  CPU_SET(cpu % std::thread::hardware_concurrency(), &cpuset);
+  pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuset);
+}
+
+/**
+ * Fixed size message used for payload size sweeps
+ */
+template <size_t SIZE>
+struct Payload {
+  static_assert(SIZE >= sizeof(int64_t));
+
+  Payload() = default;
+  Payload(const int64_t value) : seq{value} {}
+
+  int64_t seq;
+  char data[SIZE - sizeof(int64_t)];
+};
+
+/**
+ * Baseline bounded queue guarded by a mutex
+ */
+template <typename T, uint32_t MAX_SIZE>
+class MutexQueue {
+ public:
+  bool Write(const T &value) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (queue_.size() >= MAX_SIZE) return false;
+    queue_.push(value);
+    return true;
+  }
+
+  bool Read(T &record) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (queue_.empty()) return false;
+    record = std::move(queue_.front());
+    queue_.pop();
+    return true;
+  }
+
+ private:
+  std::mutex mutex_;
+  std::queue<T> queue_;
+};
+
+}  // namespace hermes::perf
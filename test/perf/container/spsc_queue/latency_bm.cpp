@@ -0,0 +1,95 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "hermes/container/spsc_queue.h"
+#include "test/perf/container/spsc_queue/bm_util.h"
+
+namespace bm = benchmark;
+using hermes::perf::MutexQueue;
+using hermes::perf::Payload;
+using hermes::perf::PinThread;
+
+namespace {
+
+constexpr uint32_t QUEUE_SIZE = 1 << 10;
+
+double Percentile(const std::vector<int64_t> &sorted, const double p) {
+  return sorted[std::min(sorted.size() - 1, size_t(sorted.size() * p))];
+}
+
+// Ping-pong state.range(0) values through a pair of queues, the echo thread
+// sends every value straight back. Reports round trip percentiles in ns
+template <typename Queue, typename T>
+void RunPingPong(bm::State &state) {
+  using Clock = std::chrono::steady_clock;
+
+  const int64_t size = state.range(0);
+  auto ping = std::make_unique<Queue>();
+  auto pong = std::make_unique<Queue>();
+
+  std::vector<int64_t> samples;
+  samples.reserve(size * 4);
+
+  PinThread(hermes::perf::PRODUCER_CPU);
+  for (auto _ : state) {
+    std::thread echo_th([&]() {
+      PinThread(hermes::perf::CONSUMER_CPU);
+      T value{};
+      for (int64_t i = 0; i < size; ++i) {
+        while (!ping->Read(value)) {
+        }
+        while (!pong->Write(value)) {
+        }
+      }
+    });
+
+    T value{};
+    for (int64_t i = 0; i < size; ++i) {
+      const auto start = Clock::now();
+      while (!ping->Write(T{i})) {
+      }
+      while (!pong->Read(value)) {
+      }
+      samples.push_back((Clock::now() - start).count());
+    }
+    bm::DoNotOptimize(value);
+
+    echo_th.join();
+  }
+
+  std::sort(samples.begin(), samples.end());
+  state.counters["p50_ns"] = Percentile(samples, 0.5);
+  state.counters["p99_ns"] = Percentile(samples, 0.99);
+  state.counters["p999_ns"] = Percentile(samples, 0.999);
+  state.SetItemsProcessed(state.iterations() * size);
+}
+
+}  // namespace
+
+template <typename T>
+static void mutexQueuePingPongBM(bm::State &state) {
+  RunPingPong<MutexQueue<T, QUEUE_SIZE>, T>(state);
+}
+
+template <typename T>
+static void hermesSpscPingPongBM(bm::State &state) {
+  RunPingPong<hermes::container::SpscQueue<T, QUEUE_SIZE>, T>(state);
+}
+
+BENCHMARK(mutexQueuePingPongBM<int64_t>)->Arg(1 << 16)->UseRealTime();
+BENCHMARK(hermesSpscPingPongBM<int64_t>)->Arg(1 << 16)->UseRealTime();
+
+// payload size sweep
+BENCHMARK(mutexQueuePingPongBM<Payload<256>>)->Arg(1 << 16)->UseRealTime();
+BENCHMARK(hermesSpscPingPongBM<Payload<256>>)->Arg(1 << 16)->UseRealTime();
+
+BENCHMARK(mutexQueuePingPongBM<Payload<1024>>)->Arg(1 << 16)->UseRealTime();
+BENCHMARK(hermesSpscPingPongBM<Payload<1024>>)->Arg(1 << 16)->UseRealTime();
+
+BENCHMARK_MAIN();
@@ -0,0 +1,121 @@
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+#include <memory>
+#include <thread>
+
+#include "hermes/container/spsc_queue.h"
+#include "test/perf/container/spsc_queue/bm_util.h"
+
+namespace bm = benchmark;
+using hermes::perf::MutexQueue;
+using hermes::perf::Payload;
+using hermes::perf::PinThread;
+
+namespace {
+
+constexpr uint32_t QUEUE_SIZE = 1 << 16;
+
+/**
+ * Baseline queue which loads the remote index on every call, this is what
+ * SpscQueue did before it cached the remote index on each side. It shares
+ * SpscQueue's index policy so caching is the only difference measured
+ */
+template <typename T, uint32_t MAX_SIZE>
+class UncachedSpscQueue {
+  using IndexPolicy = hermes::container::detail::SpscIndex<MAX_SIZE>;
+  using Index = typename IndexPolicy::Index;
+
+ public:
+  bool Write(const T &value) {
+    const auto curr_read = read_index_.load(std::memory_order_acquire);
+    const auto curr_write = write_index_.load(std::memory_order_relaxed);
+
+    if (IndexPolicy::IsFull(curr_write, curr_read)) return false;
+
+    data_[IndexPolicy::Slot(curr_write)] = value;
+    write_index_.store(IndexPolicy::Advance(curr_write, 1),
+                       std::memory_order_release);
+    return true;
+  }
+
+  bool Read(T &record) {
+    const auto curr_write = write_index_.load(std::memory_order_acquire);
+    const auto curr_read = read_index_.load(std::memory_order_relaxed);
+
+    if (curr_read == curr_write) return false;
+
+    record = data_[IndexPolicy::Slot(curr_read)];
+    read_index_.store(IndexPolicy::Advance(curr_read, 1),
+                      std::memory_order_release);
+    return true;
+  }
+
+ private:
+  T data_[IndexPolicy::SLOTS];
+
+  alignas(64) std::atomic<Index> write_index_{0};
+  alignas(64) std::atomic<Index> read_index_{0};
+};
+
+// Stream state.range(0) values from a producer pinned to PRODUCER_CPU to a
+// consumer pinned to CONSUMER_CPU
+template <typename Queue, typename T>
+void RunThroughput(bm::State &state) {
+  const int64_t size = state.range(0);
+  auto queue = std::make_unique<Queue>();
+
+  PinThread(hermes::perf::CONSUMER_CPU);
+  for (auto _ : state) {
+    std::thread producer_th([&]() {
+      PinThread(hermes::perf::PRODUCER_CPU);
+      for (int64_t i = 0; i < size; ++i)
+        while (!queue->Write(T{i})) {
+        }
+    });
+
+    T value{};
+    for (int64_t i = 0; i < size; ++i)
+      while (!queue->Read(value)) {
+      }
+    bm::DoNotOptimize(value);
+
+    producer_th.join();
+  }
+
+  state.SetItemsProcessed(state.iterations() * size);
+  state.SetBytesProcessed(state.iterations() * size * sizeof(T));
+}
+
+}  // namespace
+
+template <typename T>
+static void mutexQueueThroughputBM(bm::State &state) {
+  RunThroughput<MutexQueue<T, QUEUE_SIZE>, T>(state);
+}
+
+template <typename T>
+static void uncachedSpscThroughputBM(bm::State &state) {
+  RunThroughput<UncachedSpscQueue<T, QUEUE_SIZE>, T>(state);
+}
+
+template <typename T>
+static void hermesSpscThroughputBM(bm::State &state) {
+  RunThroughput<hermes::container::SpscQueue<T, QUEUE_SIZE>, T>(state);
+}
+
+BENCHMARK(mutexQueueThroughputBM<int64_t>)->Arg(1 << 22)->UseRealTime();
+BENCHMARK(uncachedSpscThroughputBM<int64_t>)->Arg(1 << 22)->UseRealTime();
+BENCHMARK(hermesSpscThroughputBM<int64_t>)->Arg(1 << 22)->UseRealTime();
+
+// payload size sweep
+BENCHMARK(mutexQueueThroughputBM<Payload<64>>)->Arg(1 << 20)->UseRealTime();
+BENCHMARK(hermesSpscThroughputBM<Payload<64>>)->Arg(1 << 20)->UseRealTime();
+
+BENCHMARK(mutexQueueThroughputBM<Payload<256>>)->Arg(1 << 20)->UseRealTime();
+BENCHMARK(hermesSpscThroughputBM<Payload<256>>)->Arg(1 << 20)->UseRealTime();
+
+BENCHMARK(mutexQueueThroughputBM<Payload<1024>>)->Arg(1 << 18)->UseRealTime();
+BENCHMARK(hermesSpscThroughputBM<Payload<1024>>)->Arg(1 << 18)->UseRealTime();
+
+BENCHMARK_MAIN();
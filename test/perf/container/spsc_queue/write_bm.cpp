@@ -1,15 +1,64 @@
 #include <benchmark/benchmark.h>
 
+#include <memory>
+
 #include "hermes/container/spsc_queue.h"
+#include "test/perf/container/spsc_queue/bm_util.h"
 
 namespace bm = benchmark;
+using hermes::perf::MutexQueue;
+using hermes::perf::Payload;
+
+namespace {
 
-static void hermesSpscIntBm(bm::State &state) {
+constexpr uint32_t QUEUE_SIZE = 1 << 10;
+
+// Write then read back batches of state.range(0) values on one thread
+template <typename Queue, typename T>
+void RunWriteRead(bm::State &state) {
   const auto size = state.range(0);
+  auto queue = std::make_unique<Queue>();
+
+  T value{};
   for (auto _ : state) {
+    for (auto i = 0; i < size; ++i) queue->Write(T{i});
+    for (auto i = 0; i < size; ++i) queue->Read(value);
+
+    bm::DoNotOptimize(value);
   }
+
+  state.SetItemsProcessed(state.iterations() * size);
+  state.SetBytesProcessed(state.iterations() * size * sizeof(T));
 }
 
-BENCHMARK(hermesSpscIntBm)->Range(0, 10000);
+}  // namespace
+
+template <typename T>
+static void hermesSpscWriteReadBM(bm::State &state) {
+  RunWriteRead<hermes::container::SpscQueue<T, QUEUE_SIZE>, T>(state);
+}
+
+template <typename T>
+static void mutexQueueWriteReadBM(bm::State &state) {
+  RunWriteRead<MutexQueue<T, QUEUE_SIZE>, T>(state);
+}
+
+// single value cost
+BENCHMARK(hermesSpscWriteReadBM<int64_t>)->Arg(1);
+BENCHMARK(mutexQueueWriteReadBM<int64_t>)->Arg(1);
+
+// batch cost
+BENCHMARK(hermesSpscWriteReadBM<int64_t>)->Arg(QUEUE_SIZE);
+BENCHMARK(mutexQueueWriteReadBM<int64_t>)->Arg(QUEUE_SIZE);
+
+// payload size sweep
+BENCHMARK(hermesSpscWriteReadBM<Payload<64>>)->Arg(QUEUE_SIZE);
+BENCHMARK(mutexQueueWriteReadBM<Payload<64>>)->Arg(QUEUE_SIZE);
+
+BENCHMARK(hermesSpscWriteReadBM<Payload<256>>)->Arg(QUEUE_SIZE);
+BENCHMARK(mutexQueueWriteReadBM<Payload<256>>)->Arg(QUEUE_SIZE);
+
+BENCHMARK(hermesSpscWriteReadBM<Payload<1024>>)->Arg(QUEUE_SIZE);
+BENCHMARK(mutexQueueWriteReadBM<Payload<1024>>)->Arg(QUEUE_SIZE);
 
 BENCHMARK_MAIN();
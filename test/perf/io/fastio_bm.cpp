@@ -2,9 +2,13 @@
 
 #include <filesystem>
 #include <fstream>
+#include <iomanip>
 #include <iostream>
+#include <string>
+#include <vector>
 
 #include "hermes/io/fastio.h"
+#include "hermes/io/parallel_fastio.h"
 #include "hermes/random/random.h"
 
 namespace bm = benchmark;
@@ -41,7 +45,156 @@ static void hermesIFIntBM(bm::State &state) {
   std::filesystem::remove(filename);
 }
 
+static void hermesIFReadManyBM(bm::State &state) {
+  const int data_size = state.range(0);
+  const auto filename = "data_many.txt";
+  GenerateData(filename, data_size);
+
+  std::vector<uint64_t> values(data_size);
+  for (auto _ : state) {
+    hermes::io::IntegralFastIO<uint64_t> reader;
+    reader.Init(filename);
+
+    bm::DoNotOptimize(reader.ReadMany(values.data(), values.size()));
+    bm::ClobberMemory();
+  }
+
+  std::filesystem::remove(filename);
+}
+
+static void hermesParallelReadAllBM(bm::State &state) {
+  const int data_size = state.range(0);
+  const auto filename = "data_parallel.txt";
+  GenerateData(filename, data_size);
+
+  for (auto _ : state) {
+    hermes::io::ParallelFastIO<uint64_t> reader;
+    reader.Init(filename);
+
+    hermes::container::Vector<uint64_t> values;
+    bm::DoNotOptimize(reader.ReadAll(values, state.range(1)));
+    bm::ClobberMemory();
+  }
+
+  std::filesystem::remove(filename);
+}
+
+// Character at a time baseline for the vector digit parsing of ReadOne
+static void hermesIFIntScalarBM(bm::State &state) {
+  const int data_size = state.range(0);
+  const auto filename = "data_scalar.txt";
+  GenerateData(filename, data_size);
+
+  const int MAX_BUFFER_SIZE = 1 << 16;
+  for (auto _ : state) {
+    hermes::io::IntegralFastIO<uint64_t, MAX_BUFFER_SIZE> reader;
+    reader.Init(filename);
+
+    while (reader.IsGood()) {
+      bm::DoNotOptimize(reader.ReadOneScalar());
+    }
+
+    bm::DoNotOptimize(reader);
+  }
+
+  std::filesystem::remove(filename);
+}
+
+void GeneratePriceData(const std::string &filename, const int data_size) {
+  std::ofstream outfile(filename, std::ios::out | std::ios::trunc);
+
+  for (auto i = 0; i < data_size; ++i) {
+    // fixed width fraction, x.0500 and not x.500
+    outfile << rnd::IntegralRandom::RandT<uint32_t>() % 100000 << '.'
+            << std::setw(4) << std::setfill('0')
+            << rnd::IntegralRandom::RandT<uint32_t>() % 10000 << ' ';
+  }
+
+  outfile.flush();
+  outfile.close();
+}
+
+static void hermesFFDoubleBM(bm::State &state) {
+  const int data_size = state.range(0);
+  const auto filename = "data_double.txt";
+  GeneratePriceData(filename, data_size);
+
+  const int MAX_BUFFER_SIZE = 1 << 16;
+  for (auto _ : state) {
+    hermes::io::FloatFastIO<double, MAX_BUFFER_SIZE> reader;
+    reader.Init(filename);
+
+    while (reader.IsGood()) {
+      bm::DoNotOptimize(reader.ReadOne());
+    }
+
+    bm::DoNotOptimize(reader);
+  }
+
+  std::filesystem::remove(filename);
+}
+
+// strtod baseline for FloatFastIO
+static void strtodDoubleBM(bm::State &state) {
+  const int data_size = state.range(0);
+  const auto filename = "data_strtod.txt";
+  GeneratePriceData(filename, data_size);
+
+  std::ifstream infile(filename);
+  const std::string data((std::istreambuf_iterator<char>(infile)),
+                         std::istreambuf_iterator<char>());
+
+  for (auto _ : state) {
+    const char *ptr = data.c_str();
+    char *end;
+    while (true) {
+      const auto value = std::strtod(ptr, &end);
+      if (end == ptr) break;
+      bm::DoNotOptimize(value);
+      ptr = end;
+    }
+  }
+
+  std::filesystem::remove(filename);
+}
+
+// Whole file mapping (range(1) = 1) against 8 KB remap windows
+static void hermesIFMappingBM(bm::State &state) {
+  const int data_size = state.range(0);
+  const auto filename = "data_mapping.txt";
+  GenerateData(filename, data_size);
+
+  hermes::io::FastIOOptions options;
+  if (!state.range(1)) options.max_mapping_size = 0;
+
+  for (auto _ : state) {
+    hermes::io::IntegralFastIO<uint64_t> reader;
+    reader.Init(filename, options);
+
+    while (reader.IsGood()) {
+      bm::DoNotOptimize(reader.ReadOne());
+    }
+
+    bm::DoNotOptimize(reader);
+  }
+
+  state.SetBytesProcessed(state.iterations() *
+                          std::filesystem::file_size(filename));
+  std::filesystem::remove(filename);
+}
+
 BENCHMARK(hermesIFIntBM)->Arg(1e5);
+BENCHMARK(hermesIFIntScalarBM)->Arg(1e5);
+BENCHMARK(hermesIFReadManyBM)->Arg(1e5);
+BENCHMARK(hermesParallelReadAllBM)
+    ->ArgsProduct({{1 << 22}, {1, 2, 4, 8}})
+    ->ArgNames({"values", "threads"})
+    ->UseRealTime();
+BENCHMARK(hermesFFDoubleBM)->Arg(1e5);
+BENCHMARK(strtodDoubleBM)->Arg(1e5);
+BENCHMARK(hermesIFMappingBM)
+    ->ArgsProduct({{1 << 10, 1 << 14, 1 << 18, 1 << 22}, {0, 1}})
+    ->ArgNames({"values", "whole_file"});
 // BENCHMARK(hermesStaticListIntBM<1 << 5>)->Arg(1 << 5);
 
 BENCHMARK_MAIN();
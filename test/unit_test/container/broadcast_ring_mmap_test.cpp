@@ -0,0 +1,287 @@
+#include "hermes/container/broadcast_ring_mmap.h"
+
+#include <sys/wait.h>
+
+#include <atomic>
+#include <catch2/catch_test_macros.hpp>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace hermes::container;
+
+namespace {
+
+struct Quote {
+  uint64_t seq;
+  double bid;
+  double ask;
+};
+
+struct Tick {
+  explicit Tick(const uint64_t seq) : seq{seq} {}
+  uint64_t seq;
+};
+
+std::string TempPath(const std::string &name) {
+  const auto path = std::filesystem::temp_directory_path() / name;
+  std::filesystem::remove(path);
+  return path.string();
+}
+
+}  // namespace
+
+TEST_CASE("Subscribe Test") {
+  const auto path = TempPath("broadcast_ring_mmap_subscribe");
+  {
+    BroadcastRingMMap<Quote, 2> writer, reader;
+    writer.Init(path, 1 << 16, true);
+    reader.Init(path, 1 << 16, false);
+    REQUIRE(reader.Capacity() == writer.Capacity());
+
+    // without readers the writer publishes freely
+    for (uint64_t i = 0; i < 10; ++i) writer.Write(Quote{i, 0, 0});
+
+    const auto first = reader.Subscribe();
+    const auto second = reader.Subscribe();
+    REQUIRE(first != reader.INVALID_READER);
+    REQUIRE(second != reader.INVALID_READER);
+    REQUIRE(reader.Subscribe() == reader.INVALID_READER);
+    REQUIRE(writer.IsSubscribed(first));
+
+    // readers start at the current write position
+    Quote quote;
+    REQUIRE_FALSE(reader.Read(first, quote));
+
+    // every reader sees every value
+    for (uint64_t i = 10; i < 20; ++i) writer.Write(Quote{i, 0, 0});
+    REQUIRE(writer.LagGuess(first) == 10);
+    for (uint64_t i = 10; i < 20; ++i) {
+      REQUIRE(reader.Read(first, quote));
+      REQUIRE(quote.seq == i);
+    }
+    uint64_t expected = 10;
+    REQUIRE(reader.ConsumeAll(second, [&](const Quote &quote) {
+      REQUIRE(quote.seq == expected++);
+    }) == 10);
+    REQUIRE(writer.LagGuess(second) == 0);
+
+    reader.Unsubscribe(second);
+    REQUIRE_FALSE(writer.IsSubscribed(second));
+    REQUIRE(reader.Subscribe() == second);
+  }
+  std::filesystem::remove(path);
+}
+
+TEST_CASE("Slow Reader Test") {
+  const auto path = TempPath("broadcast_ring_mmap_slow_reader");
+  {
+    BroadcastRingMMap<Quote> ring;
+    ring.Init(path, 4096, true);
+    const auto fast = ring.Subscribe();
+    const auto slow = ring.Subscribe();
+    const auto capacity = ring.Capacity();
+
+    // the writer never waits, the slow reader gets lapped
+    uint64_t fast_expected = 0;
+    for (uint64_t i = 0; i < 3 * capacity; ++i) {
+      ring.Write(Quote{i, 0, 0});
+      ring.ConsumeAll(fast, [&](const Quote &quote) {
+        REQUIRE(quote.seq == fast_expected++);
+      });
+    }
+    REQUIRE(fast_expected == 3 * capacity);
+    REQUIRE(ring.Dropped(fast) == 0);
+    REQUIRE(ring.LagGuess(slow) > capacity);
+
+    // a lapped reader skips to the newest value and reports what it lost
+    Quote quote;
+    REQUIRE(ring.Read(slow, quote));
+    REQUIRE(quote.seq == 3 * capacity - 1);
+    REQUIRE(ring.Dropped(slow) == 3 * capacity - 1);
+    REQUIRE_FALSE(ring.Read(slow, quote));
+  }
+  std::filesystem::remove(path);
+}
+
+TEST_CASE("Dead Reader Test") {
+  const auto path = TempPath("broadcast_ring_mmap_dead_reader");
+  {
+    BroadcastRingMMap<Quote, 1> ring;
+    ring.Init(path, 4096, true);
+
+    const auto pid = fork();
+    REQUIRE(pid != -1);
+    if (pid == 0) {
+      BroadcastRingMMap<Quote, 1> reader;
+      reader.Init(path, 4096, false);
+      _exit(reader.Subscribe() == reader.INVALID_READER);
+    }
+
+    int status;
+    waitpid(pid, &status, 0);
+    REQUIRE(WIFEXITED(status));
+    REQUIRE(WEXITSTATUS(status) == 0);
+
+    // the reader exited without unsubscribing
+    REQUIRE(ring.Subscribe() == ring.INVALID_READER);
+    REQUIRE(ring.ReleaseDeadReaders() == 1);
+    const auto id = ring.Subscribe();
+    REQUIRE(id != ring.INVALID_READER);
+    REQUIRE(ring.ReleaseDeadReaders() == 0);
+    ring.Unsubscribe(id);
+
+    // a reader that died inside Subscribe, before publishing its cursor
+    {
+      MMapFile file;
+      file.Open(path, 4096, false);
+      using Cursor = detail::MMapReaderCursor;
+      auto *cursor = reinterpret_cast<Cursor *>(file.Data() + 2 * 64);
+      cursor->owner.store(Cursor::Owner(pid, Cursor::CLAIMING));
+    }
+    REQUIRE(ring.Subscribe() == ring.INVALID_READER);
+    REQUIRE(ring.ReleaseDeadReaders() == 1);
+    REQUIRE(ring.Subscribe() != ring.INVALID_READER);
+  }
+  std::filesystem::remove(path);
+}
+
+TEST_CASE("Release While Subscribing Test") {
+  const auto path = TempPath("broadcast_ring_mmap_release_race");
+  {
+    BroadcastRingMMap<Quote, 1> ring;
+    ring.Init(path, 4096, true);
+
+    // leave the dead pid of a crashed reader in the only cursor
+    const auto pid = fork();
+    REQUIRE(pid != -1);
+    if (pid == 0) {
+      BroadcastRingMMap<Quote, 1> reader;
+      reader.Init(path, 4096, false);
+      _exit(reader.Subscribe() == reader.INVALID_READER);
+    }
+    waitpid(pid, nullptr, 0);
+    REQUIRE(ring.ReleaseDeadReaders() == 1);
+
+    // a live reader reusing the cursor is never taken for the dead one
+    std::atomic<bool> done{false};
+    std::thread subscriber([&]() {
+      for (auto i = 0; i < 100000; ++i) {
+        const auto id = ring.Subscribe();
+        if (id != ring.INVALID_READER) ring.Unsubscribe(id);
+      }
+      done = true;
+    });
+
+    uint32_t released = 0;
+    while (!done) released += ring.ReleaseDeadReaders();
+    subscriber.join();
+    REQUIRE(released == 0);
+  }
+  std::filesystem::remove(path);
+}
+
+TEST_CASE("Cross-process Fan Out Test") {
+  constexpr uint64_t data_size = 1e5;
+  constexpr int reader_count = 4;
+  const auto path = TempPath("broadcast_ring_mmap_fan_out");
+
+  BroadcastRingMMap<Quote> writer;
+  writer.Init(path, 1 << 20, true);
+
+  // readers subscribe before forking so none misses the first value
+  std::vector<pid_t> pids;
+  for (int r = 0; r < reader_count; ++r) {
+    const auto id = writer.Subscribe();
+    REQUIRE(id != writer.INVALID_READER);
+
+    const auto pid = fork();
+    REQUIRE(pid != -1);
+    if (pid == 0) {
+      BroadcastRingMMap<Quote> reader;
+      reader.Init(path, 1 << 20, false);
+
+      // values arrive in order, lapped ones are accounted as dropped
+      uint64_t next = 0, received = 0;
+      bool ordered = true;
+      while (next < data_size) {
+        reader.ConsumeAll(id, [&](const Quote &quote) {
+          ordered &= quote.seq >= next && quote.bid == quote.seq;
+          next = quote.seq + 1;
+          received += 1;
+        });
+      }
+      ordered &= received + reader.Dropped(id) == data_size;
+      _exit(ordered ? 0 : 1);
+    }
+    pids.push_back(pid);
+  }
+
+  for (uint64_t i = 0; i < data_size; ++i)
+    writer.Write(Quote{i, double(i), double(i)});
+
+  for (const auto pid : pids) {
+    int status;
+    waitpid(pid, &status, 0);
+    REQUIRE(WIFEXITED(status));
+    REQUIRE(WEXITSTATUS(status) == 0);
+  }
+
+  std::filesystem::remove(path);
+}
+
+TEST_CASE("No Default Constructor Read Test") {
+  const auto path = TempPath("broadcast_ring_mmap_no_default");
+  {
+    BroadcastRingMMap<Tick, 2> ring;
+    REQUIRE(ring.Init(path, 4096, true));
+    const auto id = ring.Subscribe();
+
+    for (uint64_t i = 0; i < 4; ++i) ring.Write(Tick{i});
+    Tick tick{0};
+    REQUIRE(ring.Read(id, tick));
+    REQUIRE(tick.seq == 0);
+
+    uint64_t expected = 1;
+    REQUIRE(ring.ConsumeAll(id, [&](const Tick &tick) {
+      REQUIRE(tick.seq == expected++);
+    }) == 3);
+  }
+  std::filesystem::remove(path);
+}
+
+TEST_CASE("Late Header Attach Test") {
+  const auto path = TempPath("broadcast_ring_mmap_late_header");
+  std::ofstream(path).close();
+  std::filesystem::resize_file(path, 1 << 16);
+
+  // the reader maps the file before the writer built the header
+  BroadcastRingMMap<Quote, 2> reader;
+  bool attached = false;
+  std::thread reader_th(
+      [&]() { attached = reader.Init(path, 1 << 16, false); });
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  BroadcastRingMMap<Quote, 2> writer;
+  REQUIRE(writer.Init(path, 1 << 16, true));
+  reader_th.join();
+  REQUIRE(attached);
+
+  const auto id = reader.Subscribe();
+  writer.Write(Quote{5, 0, 0});
+  Quote quote;
+  REQUIRE(reader.Read(id, quote));
+  REQUIRE(quote.seq == 5);
+
+  // a header that is never built times out instead of aborting
+  std::filesystem::remove(path);
+  std::ofstream(path).close();
+  std::filesystem::resize_file(path, 1 << 16);
+  BroadcastRingMMap<Quote, 2> orphan;
+  REQUIRE_FALSE(orphan.Init(path, 1 << 16, false));
+
+  std::filesystem::remove(path);
+}
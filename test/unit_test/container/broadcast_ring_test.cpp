@@ -0,0 +1,135 @@
+#include "hermes/container/broadcast_ring.h"
+
+#include <atomic>
+#include <catch2/catch_test_macros.hpp>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace hermes::container;
+
+TEST_CASE("Init Test") { BroadcastRing<int, 1024> ring; }
+
+TEST_CASE("Subscribe Test") {
+  BroadcastRing<int, 8, 2> ring;
+
+  // without readers the producer never blocks
+  for (auto i = 0; i < 100; ++i) REQUIRE(ring.Write(i));
+
+  const auto first = ring.Subscribe();
+  const auto second = ring.Subscribe();
+  REQUIRE(first != ring.INVALID_READER);
+  REQUIRE(second != ring.INVALID_READER);
+  REQUIRE(ring.Subscribe() == ring.INVALID_READER);
+
+  // readers start at the current write position
+  int val;
+  REQUIRE_FALSE(ring.Read(first, val));
+
+  ring.Unsubscribe(second);
+  REQUIRE(ring.Subscribe() == second);
+}
+
+TEST_CASE("Back Pressure Test") {
+  BroadcastRing<std::string, 4> ring;
+  const auto fast = ring.Subscribe();
+  const auto slow = ring.Subscribe();
+
+  for (auto i = 0; i < 4; ++i) REQUIRE(ring.Write(std::to_string(i)));
+  REQUIRE_FALSE(ring.Write("full"));
+
+  // the fast reader alone does not free any slot
+  REQUIRE(ring.ConsumeAll(fast, [](const std::string &) {}) == 4);
+  REQUIRE_FALSE(ring.Write("full"));
+  REQUIRE(ring.LagGuess(slow) == 4);
+
+  std::string val;
+  REQUIRE(ring.Read(slow, val));
+  REQUIRE(val == "0");
+  REQUIRE(ring.Write("4"));
+  REQUIRE_FALSE(ring.Write("full"));
+
+  // dropping the slow reader releases the producer
+  ring.Unsubscribe(slow);
+  REQUIRE(ring.Write("5"));
+
+  std::vector<std::string> seen;
+  ring.ConsumeAll(fast, [&](const std::string &v) { seen.push_back(v); });
+  REQUIRE(seen == std::vector<std::string>{"4", "5"});
+}
+
+TEST_CASE("Multi-reader Test") {
+  constexpr uint32_t reader_count = 3;
+  constexpr uint64_t data_size = 1e5;
+  BroadcastRing<uint64_t, 1024> ring;
+
+  std::vector<BroadcastRing<uint64_t, 1024>::ReaderId> ids;
+  for (uint32_t r = 0; r < reader_count; ++r) ids.push_back(ring.Subscribe());
+
+  std::vector<char> ordered(reader_count, false);
+  std::vector<std::thread> readers;
+  for (uint32_t r = 0; r < reader_count; ++r) {
+    readers.emplace_back([&, r]() {
+      uint64_t expected = 0;
+      bool ok = true;
+      while (expected < data_size) {
+        ring.ConsumeAll(ids[r], [&](const uint64_t &v) {
+          ok &= v == expected;
+          expected += 1;
+        });
+      }
+      ordered[r] = ok;
+    });
+  }
+
+  for (uint64_t i = 0; i < data_size; ++i)
+    while (!ring.Write(i)) {
+    }
+  for (auto &th : readers) th.join();
+
+  for (uint32_t r = 0; r < reader_count; ++r) REQUIRE(ordered[r]);
+}
+
+TEST_CASE("Subscribe While Writing Test") {
+  constexpr uint32_t reader_count = 3;
+  constexpr uint64_t data_size = 2e5;
+  BroadcastRing<uint64_t, 8> ring;
+  std::atomic<uint64_t> written{0};
+
+  // readers join and leave while the producer runs, every value they see
+  // must be a contiguous run starting no earlier than the join, a reader
+  // starting on overwritten slots would see values jump back
+  std::vector<char> ordered(reader_count, false);
+  std::vector<std::thread> readers;
+  for (uint32_t r = 0; r < reader_count; ++r) {
+    readers.emplace_back([&, r]() {
+      bool ok = true;
+      while (written.load(std::memory_order_acquire) < data_size) {
+        const auto joined = written.load(std::memory_order_acquire);
+        const auto id = ring.Subscribe();
+        if (id == ring.INVALID_READER) continue;
+
+        uint64_t expected = 0;
+        bool first = true;
+        for (auto i = 0; i < 64; ++i) {
+          uint64_t val;
+          if (!ring.Read(id, val)) continue;
+          ok &= first ? val >= joined : val == expected;
+          expected = val + 1;
+          first = false;
+        }
+        ring.Unsubscribe(id);
+      }
+      ordered[r] = ok;
+    });
+  }
+
+  for (uint64_t i = 0; i < data_size; ++i) {
+    while (!ring.Write(i)) {
+    }
+    written.store(i + 1, std::memory_order_release);
+  }
+  for (auto &th : readers) th.join();
+
+  for (uint32_t r = 0; r < reader_count; ++r) REQUIRE(ordered[r]);
+}
@@ -0,0 +1,177 @@
+#include "hermes/container/mmap_journal.h"
+
+#include <catch2/catch_test_macros.hpp>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+using namespace hermes::container;
+
+namespace {
+
+std::string TempPath(const std::string &name) {
+  const auto path = std::filesystem::temp_directory_path() / name;
+  std::filesystem::remove(path);
+  return path.string();
+}
+
+std::string_view View(std::span<const char> payload) {
+  return {payload.data(), payload.size()};
+}
+
+std::string Payload(const uint64_t seq) {
+  return std::string(seq % 50, 'a' + seq % 26) + std::to_string(seq);
+}
+
+}  // namespace
+
+TEST_CASE("Append/Replay Test") {
+  const auto path = TempPath("mmap_journal_replay");
+  {
+    MMapJournal journal;
+    REQUIRE(journal.Init(path, 1 << 20, true));
+    REQUIRE(journal.NextSequence() == 0);
+
+    for (uint64_t i = 0; i < 1000; ++i) {
+      const auto payload = Payload(i);
+      REQUIRE(journal.Append(payload.data(), payload.size()));
+    }
+    REQUIRE(journal.NextSequence() == 1000);
+
+    // replay from arbitrary positions, including indexed ones
+    for (uint64_t from : {0, 1, 63, 64, 65, 500, 999}) {
+      uint64_t expected = from;
+      bool matched = true;
+      auto count = journal.Replay(from, [&](uint64_t seq, auto payload) {
+        matched &= seq == expected && View(payload) == Payload(seq);
+        expected += 1;
+      });
+      REQUIRE(matched);
+      REQUIRE(count == 1000 - from);
+    }
+
+    // seeking past the end lands on the end
+    REQUIRE(journal.Replay(5000, [](uint64_t, auto) {}) == 0);
+    for (const uint64_t seq : {uint64_t{1000}, uint64_t{5000}, UINT64_MAX}) {
+      const auto cursor = journal.Seek(seq);
+      REQUIRE(cursor.seq == 1000);
+      REQUIRE(cursor.offset == journal.BytesUsed());
+    }
+
+    // every seq through the index lands on its record
+    bool landed = true;
+    for (uint64_t seq = 0; seq < 1000; ++seq)
+      landed &= journal.Seek(seq).seq == seq;
+    REQUIRE(landed);
+  }
+  std::filesystem::remove(path);
+}
+
+TEST_CASE("Reserve/Commit and Poll Test") {
+  const auto path = TempPath("mmap_journal_poll");
+  {
+    MMapJournal writer, reader;
+    REQUIRE(writer.Init(path, 1 << 16, true));
+    REQUIRE(reader.Init(path, 1 << 16, false));
+
+    auto cursor = reader.Seek(0);
+    REQUIRE(reader.Poll(cursor, [](uint64_t, auto) {}) == 0);
+
+    auto buffer = writer.Reserve(32);
+    REQUIRE(buffer.size() == 32);
+    std::memcpy(buffer.data(), "tick", 4);
+    REQUIRE(writer.Commit(4) == 0);
+
+    std::vector<std::string> seen;
+    auto collect = [&](uint64_t, auto payload) {
+      seen.emplace_back(View(payload));
+    };
+    REQUIRE(reader.Poll(cursor, collect) == 1);
+
+    writer.Append("quote", 5);
+    writer.Append("trade", 5);
+    REQUIRE(reader.Poll(cursor, collect) == 2);
+    REQUIRE(seen == std::vector<std::string>{"tick", "quote", "trade"});
+  }
+  std::filesystem::remove(path);
+}
+
+TEST_CASE("Full and Reopen Test") {
+  const auto path = TempPath("mmap_journal_reopen");
+  const std::string payload(100, 'x');
+  uint64_t appended = 0;
+  {
+    MMapJournal journal;
+    REQUIRE(journal.Init(path, 4096, true));
+    while (journal.Append(payload.data(), payload.size())) appended += 1;
+    REQUIRE(appended > 0);
+  }
+
+  // a restarted writer resumes the sequence, nothing fits anymore
+  MMapJournal journal;
+  REQUIRE(journal.Init(path, 4096, false));
+  REQUIRE(journal.NextSequence() == appended);
+  REQUIRE_FALSE(journal.Append(payload.data(), payload.size()));
+  REQUIRE(journal.Replay(0, [](uint64_t, auto) {}) == appended);
+
+  // reset starts an empty journal on the same file
+  REQUIRE(journal.Init(path, 4096, true));
+  REQUIRE(journal.NextSequence() == 0);
+  REQUIRE(journal.Replay(0, [](uint64_t, auto) {}) == 0);
+
+  std::filesystem::remove(path);
+}
+
+TEST_CASE("Unpublished Header Attach Test") {
+  const auto path = TempPath("mmap_journal_unpublished");
+  std::ofstream(path).close();
+  std::filesystem::resize_file(path, 4096);
+
+  // a sized file whose header never gets published, attach gives up
+  MMapJournal journal;
+  REQUIRE_FALSE(journal.Init(path, 4096, false));
+  REQUIRE_FALSE(journal.InitReadOnly(path));
+
+  std::filesystem::remove(path);
+}
+
+TEST_CASE("Late Header Attach Test") {
+  const auto path = TempPath("mmap_journal_late_header");
+  std::ofstream(path).close();
+  std::filesystem::resize_file(path, 4096);
+
+  // a replay process maps the file before the writer wrote the header
+  MMapJournal reader;
+  bool attached = false;
+  std::thread reader_th([&]() { attached = reader.InitReadOnly(path); });
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  MMapJournal writer;
+  REQUIRE(writer.Init(path, 4096, true));
+  reader_th.join();
+
+  REQUIRE(attached);
+  REQUIRE(writer.Append("tick", 4));
+  REQUIRE(reader.Replay(0, [](uint64_t, auto) {}) == 1);
+
+  std::filesystem::remove(path);
+}
+
+TEST_CASE("Header Mismatch Attach Test") {
+  const auto path = TempPath("mmap_journal_mismatch");
+  {
+    std::ofstream file(path);
+    file << std::string(4096, 'x');
+  }
+
+  // a file holding something else fails the attach instead of aborting
+  MMapJournal journal;
+  REQUIRE_FALSE(journal.Init(path, 4096, false));
+  REQUIRE_FALSE(journal.InitReadOnly(path));
+
+  std::filesystem::remove(path);
+}
@@ -0,0 +1,99 @@
+#include "hermes/container/mpmc_queue.h"
+
+#include <atomic>
+#include <catch2/catch_test_macros.hpp>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "hermes/random/random.h"
+
+using namespace hermes::container;
+typedef hermes::random::IntegralRandom IRand;
+
+TEST_CASE("Init Test") { MpmcQueue<int, 1024> queue; }
+
+TEST_CASE("Sequential Write Test") {
+  constexpr uint32_t data_size = 1024;
+  std::vector<int> data;
+
+  MpmcQueue<int, data_size> queue;
+  for (uint32_t i = 0; i < data_size; ++i) {
+    const auto val = IRand::RandT<int>(0, data_size);
+    data.push_back(val);
+    REQUIRE(queue.Write(val));
+  }
+
+  REQUIRE_FALSE(queue.Write(0));
+  REQUIRE(queue.SizeGuess() == data_size);
+
+  for (uint32_t i = 0; i < data_size; ++i) {
+    int val;
+    REQUIRE(queue.Read(val));
+    REQUIRE(val == data[i]);
+  }
+  REQUIRE(queue.IsEmpty());
+  REQUIRE_FALSE(queue.Read().has_value());
+}
+
+TEST_CASE("Non-trivial Type Test") {
+  MpmcQueue<std::string, 4> queue;
+  for (auto round = 0; round < 10; ++round) {
+    REQUIRE(queue.Write(std::to_string(round)));
+    REQUIRE(queue.Read() == std::to_string(round));
+  }
+
+  // values still in the queue are destroyed with it
+  REQUIRE(queue.Write("left over"));
+}
+
+TEST_CASE("Over-aligned Type Test") {
+  struct alignas(64) Line {
+    uint64_t id;
+  };
+
+  // every slot keeps the alignment of its value
+  MpmcQueue<Line, 8> queue;
+  for (uint64_t i = 0; i < 8; ++i) REQUIRE(queue.Write(Line{i}));
+
+  for (uint64_t i = 0; i < 8; ++i) {
+    bool matched = false;
+    REQUIRE(queue.ConsumeOne([&](Line &line) {
+      matched = line.id == i &&
+                reinterpret_cast<uintptr_t>(&line) % alignof(Line) == 0;
+    }));
+    REQUIRE(matched);
+  }
+}
+
+TEST_CASE("Multi-producer Multi-consumer Test") {
+  constexpr uint32_t thread_count = 4;
+  constexpr uint64_t data_size = 1e5;
+  MpmcQueue<uint64_t, 1024> queue;
+
+  std::atomic<uint64_t> sum{0}, received{0};
+
+  std::vector<std::thread> threads;
+  for (uint32_t t = 0; t < thread_count; ++t) {
+    threads.emplace_back([&]() {
+      for (uint64_t i = 1; i <= data_size; ++i)
+        while (!queue.Write(i)) {
+        }
+    });
+    threads.emplace_back([&]() {
+      uint64_t local_sum = 0;
+      while (received.load() < thread_count * data_size) {
+        auto count = queue.ConsumeAll([&](uint64_t &v) { local_sum += v; });
+        received += count;
+      }
+      sum += local_sum;
+    });
+  }
+  for (auto &th : threads) th.join();
+
+  // every value is consumed exactly once
+  REQUIRE(received == thread_count * data_size);
+  REQUIRE(sum == thread_count * data_size * (data_size + 1) / 2);
+  REQUIRE(queue.IsEmpty());
+}
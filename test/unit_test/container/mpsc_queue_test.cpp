@@ -0,0 +1,105 @@
+#include "hermes/container/mpsc_queue.h"
+
+#include <catch2/catch_test_macros.hpp>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "hermes/random/random.h"
+
+using namespace hermes::container;
+typedef hermes::random::IntegralRandom IRand;
+
+TEST_CASE("Init Test") { MpscQueue<int, 1024> queue; }
+
+TEST_CASE("Sequential Write Test") {
+  constexpr uint32_t data_size = 1024;
+  std::vector<int> data;
+
+  MpscQueue<int, data_size> queue;
+  for (uint32_t i = 0; i < data_size; ++i) {
+    const auto val = IRand::RandT<int>(0, data_size);
+    data.push_back(val);
+    REQUIRE(queue.Write(val));
+  }
+
+  REQUIRE_FALSE(queue.Write(0));
+  REQUIRE(queue.SizeGuess() == data_size);
+
+  for (uint32_t i = 0; i < data_size; ++i) {
+    int val;
+    REQUIRE(queue.Read(val));
+    REQUIRE(val == data[i]);
+  }
+  REQUIRE(queue.IsEmpty());
+  REQUIRE_FALSE(queue.Read().has_value());
+}
+
+TEST_CASE("Non-trivial Type Test") {
+  MpscQueue<std::string, 4> queue;
+  for (auto round = 0; round < 10; ++round) {
+    REQUIRE(queue.Write(std::to_string(round)));
+    REQUIRE(queue.Write(std::string(3, 'x')));
+    REQUIRE(queue.Read() == std::to_string(round));
+    REQUIRE(queue.Read() == "xxx");
+  }
+
+  // values still in the queue are destroyed with it
+  REQUIRE(queue.Write("left over"));
+}
+
+TEST_CASE("Over-aligned Type Test") {
+  struct alignas(64) Line {
+    uint64_t id;
+  };
+
+  // every slot keeps the alignment of its value
+  MpscQueue<Line, 8> queue;
+  for (uint64_t i = 0; i < 8; ++i) REQUIRE(queue.Write(Line{i}));
+
+  for (uint64_t i = 0; i < 8; ++i) {
+    bool matched = false;
+    REQUIRE(queue.ConsumeOne([&](Line &line) {
+      matched = line.id == i &&
+                reinterpret_cast<uintptr_t>(&line) % alignof(Line) == 0;
+    }));
+    REQUIRE(matched);
+  }
+}
+
+TEST_CASE("Multi-producer ConsumeAll Test") {
+  constexpr uint32_t producer_count = 4;
+  constexpr uint32_t data_size = 1e5;
+  MpscQueue<uint64_t, 1024> queue;
+
+  std::vector<std::thread> producers;
+  for (uint64_t p = 0; p < producer_count; ++p) {
+    producers.emplace_back([&, p]() {
+      for (uint64_t i = 0; i < data_size; ++i)
+        while (!queue.Write(p << 32 | i)) {
+        }
+    });
+  }
+
+  // values of each producer arrive in the order they were written
+  std::vector<uint64_t> next(producer_count, 0);
+  uint64_t received = 0;
+  bool ordered = true;
+  bool bounded = true;
+  while (received < producer_count * data_size) {
+    const auto count = queue.ConsumeAll([&](uint64_t &v) {
+      auto &expected = next[v >> 32];
+      ordered &= (v & 0xffffffff) == expected;
+      expected += 1;
+    });
+    // a batch never runs past what was claimed when it started
+    bounded &= count <= queue.Capacity();
+    received += count;
+  }
+  for (auto &th : producers) th.join();
+
+  REQUIRE(ordered);
+  REQUIRE(bounded);
+  REQUIRE(queue.IsEmpty());
+}
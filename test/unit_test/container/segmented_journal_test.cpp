@@ -0,0 +1,281 @@
+#include "hermes/container/segmented_journal.h"
+
+#include <catch2/catch_test_macros.hpp>
+#include <filesystem>
+#include <iterator>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace hermes::container;
+
+namespace {
+
+std::string TempPrefix(const std::string &name) {
+  const auto dir = std::filesystem::temp_directory_path() / name;
+  std::filesystem::remove_all(dir);
+  std::filesystem::create_directories(dir);
+  return (dir / "journal").string();
+}
+
+std::string Payload(const uint64_t seq) {
+  return std::string(seq % 200, 'a' + seq % 26) + std::to_string(seq);
+}
+
+size_t SegmentFiles(const std::string &prefix) {
+  const auto dir = std::filesystem::path(prefix).parent_path();
+  return std::distance(std::filesystem::directory_iterator(dir),
+                       std::filesystem::directory_iterator{});
+}
+
+void RequireReplay(const SegmentedJournal &journal, const uint64_t from,
+                   const uint64_t end) {
+  uint64_t expected = from;
+  bool matched = true;
+  journal.Replay(from, [&](uint64_t seq, std::span<const char> payload) {
+    matched &= seq == expected &&
+               std::string_view{payload.data(), payload.size()} ==
+                   Payload(seq);
+    expected += 1;
+  });
+  REQUIRE(matched);
+  REQUIRE(expected == end);
+}
+
+}  // namespace
+
+TEST_CASE("Rolling Test") {
+  const auto prefix = TempPrefix("segmented_journal_rolling");
+  SegmentedJournalOptions options;
+  options.segment_size = 1 << 14;
+
+  std::mutex mutex;
+  std::vector<std::string> closed;
+  options.on_segment_closed = [&](const std::string &path) {
+    std::lock_guard<std::mutex> lock(mutex);
+    closed.push_back(path);
+  };
+
+  {
+    SegmentedJournal journal;
+    journal.Init(prefix, options, true);
+
+    for (uint64_t i = 0; i < 2000; ++i) {
+      const auto payload = Payload(i);
+      REQUIRE(journal.Append(payload.data(), payload.size()));
+    }
+    REQUIRE(journal.NextSequence() == 2000);
+    REQUIRE(journal.SegmentCount() > 1);
+
+    RequireReplay(journal, 0, 2000);
+    RequireReplay(journal, 1234, 2000);
+
+    // records larger than a segment never fit and do not roll the journal
+    const auto segments = journal.SegmentCount();
+    const std::string huge(1 << 14, 'x');
+    REQUIRE_FALSE(journal.Append(huge.data(), huge.size()));
+    REQUIRE(journal.SegmentCount() == segments);
+    REQUIRE(journal.NextSequence() == 2000);
+  }
+
+  std::lock_guard<std::mutex> lock(mutex);
+  REQUIRE_FALSE(closed.empty());
+  REQUIRE(closed.front() == prefix + ".000000");
+
+  std::filesystem::remove_all(std::filesystem::path(prefix).parent_path());
+}
+
+TEST_CASE("Replay While Removing Test") {
+  const auto prefix = TempPrefix("segmented_journal_removing");
+  SegmentedJournalOptions options;
+  options.segment_size = 1 << 14;
+  options.retain_segments = false;
+
+  std::vector<std::string> closed;
+  {
+    SegmentedJournal journal;
+    journal.Init(prefix, options, true);
+
+    // replays race with the background thread removing closed segments,
+    // what they see must be contiguous and end at the last record
+    for (uint64_t i = 0; i < 3000; ++i) {
+      const auto payload = Payload(i);
+      REQUIRE(journal.Append(payload.data(), payload.size()));
+
+      if (i % 100 == 99) {
+        uint64_t expected = 0, count = 0;
+        bool contiguous = true;
+        journal.Replay(0, [&](uint64_t seq, std::span<const char>) {
+          contiguous &= count == 0 || seq == expected;
+          expected = seq + 1;
+          count += 1;
+        });
+        REQUIRE(contiguous);
+        REQUIRE(expected == i + 1);
+      }
+    }
+    for (size_t i = 0; i + 1 < journal.SegmentCount(); ++i)
+      closed.push_back(journal.SegmentPath(i));
+  }
+
+  // a replay never recreates a removed segment
+  REQUIRE_FALSE(closed.empty());
+  for (const auto &path : closed) REQUIRE_FALSE(std::filesystem::exists(path));
+
+  std::filesystem::remove_all(std::filesystem::path(prefix).parent_path());
+}
+
+TEST_CASE("Reopen Test") {
+  const auto prefix = TempPrefix("segmented_journal_reopen");
+  SegmentedJournalOptions options;
+  options.segment_size = 1 << 14;
+
+  {
+    SegmentedJournal journal;
+    journal.Init(prefix, options, true);
+    for (uint64_t i = 0; i < 1000; ++i) {
+      const auto payload = Payload(i);
+      REQUIRE(journal.Append(payload.data(), payload.size()));
+    }
+  }
+
+  // a restarted writer continues the sequence in the last segment
+  {
+    SegmentedJournal journal;
+    journal.Init(prefix, options, false);
+    REQUIRE(journal.NextSequence() == 1000);
+    for (uint64_t i = 1000; i < 3000; ++i) {
+      const auto payload = Payload(i);
+      REQUIRE(journal.Append(payload.data(), payload.size()));
+    }
+    RequireReplay(journal, 0, 3000);
+  }
+
+  std::filesystem::remove_all(std::filesystem::path(prefix).parent_path());
+}
+
+TEST_CASE("Reopen Without Retained Segments Test") {
+  const auto prefix = TempPrefix("segmented_journal_reopen_removed");
+  SegmentedJournalOptions options;
+  options.segment_size = 1 << 14;
+  options.retain_segments = false;
+
+  {
+    SegmentedJournal journal;
+    journal.Init(prefix, options, true);
+    for (uint64_t i = 0; i < 3000; ++i) {
+      const auto payload = Payload(i);
+      REQUIRE(journal.Append(payload.data(), payload.size()));
+    }
+  }
+  REQUIRE_FALSE(std::filesystem::exists(prefix + ".000000"));
+
+  // the oldest segments are gone, the sequence continues from the last one
+  {
+    SegmentedJournal journal;
+    journal.Init(prefix, options, false);
+    REQUIRE(journal.NextSequence() == 3000);
+
+    uint64_t first = UINT64_MAX, expected = 0;
+    bool contiguous = true;
+    journal.Replay(0, [&](uint64_t seq, std::span<const char> payload) {
+      if (first == UINT64_MAX) first = expected = seq;
+      contiguous &= seq == expected &&
+                    std::string_view{payload.data(), payload.size()} ==
+                        Payload(seq);
+      expected += 1;
+    });
+    REQUIRE(contiguous);
+    REQUIRE(first < 3000);
+    REQUIRE(expected == 3000);
+
+    for (uint64_t i = 3000; i < 4000; ++i) {
+      const auto payload = Payload(i);
+      REQUIRE(journal.Append(payload.data(), payload.size()));
+    }
+    REQUIRE(journal.NextSequence() == 4000);
+    RequireReplay(journal, 3999, 4000);
+  }
+  REQUIRE_FALSE(std::filesystem::exists(prefix + ".000000"));
+
+  std::filesystem::remove_all(std::filesystem::path(prefix).parent_path());
+}
+
+TEST_CASE("Reopen Headerless Preallocated Segment Test") {
+  const auto prefix = TempPrefix("segmented_journal_headerless");
+  SegmentedJournalOptions options;
+  options.segment_size = 1 << 14;
+
+  std::string preallocated;
+  {
+    SegmentedJournal journal;
+    journal.Init(prefix, options, true);
+    for (uint64_t i = 0; i < 1000; ++i) {
+      const auto payload = Payload(i);
+      REQUIRE(journal.Append(payload.data(), payload.size()));
+    }
+    preallocated = journal.SegmentPath(journal.SegmentCount());
+  }
+
+  // crash after the next segment was sized but before its header was written
+  std::filesystem::remove(preallocated);
+  std::ofstream(preallocated).close();
+  std::filesystem::resize_file(preallocated, options.segment_size);
+
+  {
+    SegmentedJournal journal;
+    journal.Init(prefix, options, false);
+    REQUIRE(journal.NextSequence() == 1000);
+    for (uint64_t i = 1000; i < 2000; ++i) {
+      const auto payload = Payload(i);
+      REQUIRE(journal.Append(payload.data(), payload.size()));
+    }
+    RequireReplay(journal, 0, 2000);
+  }
+
+  std::filesystem::remove_all(std::filesystem::path(prefix).parent_path());
+}
+
+TEST_CASE("Restart Segment Count Test") {
+  const auto prefix = TempPrefix("segmented_journal_restart");
+  SegmentedJournalOptions options;
+  options.segment_size = 1 << 14;
+
+  {
+    SegmentedJournal journal;
+    journal.Init(prefix, options, true);
+    for (uint64_t i = 0; i < 3000; ++i) {
+      const auto payload = Payload(i);
+      REQUIRE(journal.Append(payload.data(), payload.size()));
+    }
+  }
+  const auto retained = SegmentFiles(prefix);
+  REQUIRE(retained > 2);
+
+  // restarts without rolling reuse the preallocated segment
+  for (auto restart = 0; restart < 5; ++restart) {
+    SegmentedJournal journal;
+    journal.Init(prefix, options, false);
+    REQUIRE(journal.NextSequence() == 3000);
+  }
+  REQUIRE(SegmentFiles(prefix) == retained);
+
+  // segments found on startup take the close path of rolled segments
+  std::vector<std::string> closed;
+  options.retain_segments = false;
+  options.on_segment_closed = [&](const std::string &path) {
+    closed.push_back(path);
+  };
+  for (auto restart = 0; restart < 5; ++restart) {
+    SegmentedJournal journal;
+    journal.Init(prefix, options, false);
+    REQUIRE(journal.NextSequence() == 3000);
+    RequireReplay(journal, 2999, 3000);
+  }
+  REQUIRE(SegmentFiles(prefix) == 2);
+  REQUIRE(closed.empty());
+
+  std::filesystem::remove_all(std::filesystem::path(prefix).parent_path());
+}
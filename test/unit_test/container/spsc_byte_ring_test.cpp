@@ -0,0 +1,124 @@
+#include "hermes/container/spsc_byte_ring.h"
+
+#include <catch2/catch_test_macros.hpp>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "hermes/random/random.h"
+
+using namespace hermes::container;
+typedef hermes::random::IntegralRandom IRand;
+
+namespace {
+
+std::string_view View(std::span<const char> record) {
+  return {record.data(), record.size()};
+}
+
+}  // namespace
+
+TEST_CASE("Init Test") { SpscByteRing<1024> ring; }
+
+TEST_CASE("Sequential Write/Peek Test") {
+  SpscByteRing<1024> ring;
+  REQUIRE(ring.IsEmpty());
+  REQUIRE(ring.Peek().empty());
+
+  const std::vector<std::string> data = {"a", "hello", "", "hermes"};
+  for (const auto &s : data) REQUIRE(ring.Write(s.data(), s.size()));
+
+  for (const auto &s : data) {
+    auto record = ring.Peek();
+    REQUIRE(View(record) == s);
+    ring.Release();
+  }
+  REQUIRE(ring.IsEmpty());
+}
+
+TEST_CASE("Reserve/Commit Test") {
+  SpscByteRing<256> ring;
+
+  // oversized records are rejected
+  REQUIRE(ring.Reserve(ring.MAX_RECORD_SIZE + 1).empty());
+
+  auto buffer = ring.Reserve(64);
+  REQUIRE(buffer.size() == 64);
+  std::memcpy(buffer.data(), "shrunk", 6);
+
+  // nothing is visible before commit
+  REQUIRE(ring.Peek().empty());
+  ring.Commit(6);
+  REQUIRE(View(ring.Peek()) == "shrunk");
+  ring.Release();
+}
+
+TEST_CASE("Payload Alignment Test") {
+  SpscByteRing<256> ring;
+
+  // odd sizes move the write position but every payload stays aligned
+  for (uint32_t size = 0; size < 40; ++size) {
+    auto buffer = ring.Reserve(size);
+    REQUIRE(buffer.data() != nullptr);
+    REQUIRE(reinterpret_cast<uintptr_t>(buffer.data()) % ring.RECORD_ALIGN ==
+            0);
+    ring.Commit(size);
+
+    auto record = ring.Peek();
+    REQUIRE(record.size() == size);
+    REQUIRE(reinterpret_cast<uintptr_t>(record.data()) % ring.RECORD_ALIGN ==
+            0);
+    ring.Release();
+  }
+}
+
+TEST_CASE("Wrap Padding Test") {
+  SpscByteRing<128> ring;
+  const std::string big(40, 'x');
+
+  // 48 byte records take 48 bytes, the third one does not fit before the
+  // end of the ring and wraps to the front
+  REQUIRE(ring.Write(big.data(), big.size()));
+  REQUIRE(ring.Write(big.data(), big.size()));
+  REQUIRE_FALSE(ring.Write(big.data(), big.size()));
+
+  REQUIRE(View(ring.Peek()) == big);
+  ring.Release();
+  REQUIRE(ring.Write(big.data(), big.size()));
+  REQUIRE(ring.BytesUsedGuess() == 48 + 32 + 48);
+
+  size_t count = ring.ConsumeAll([&](std::span<const char> record) {
+    REQUIRE(View(record) == big);
+  });
+  REQUIRE(count == 2);
+  REQUIRE(ring.IsEmpty());
+}
+
+TEST_CASE("Multi-thread Write/ConsumeAll Test") {
+  constexpr uint32_t data_size = 1e5;
+  std::vector<std::string> data;
+  for (uint32_t i = 0; i < data_size; ++i)
+    data.emplace_back(IRand::RandT<int>(0, 200), char('a' + i % 26));
+
+  SpscByteRing<1 << 12> ring;
+
+  std::thread sender_th([&]() {
+    for (const auto &s : data)
+      while (!ring.Write(s.data(), s.size())) {
+      }
+  });
+
+  uint32_t idx = 0;
+  bool matched = true;
+  while (idx < data_size) {
+    ring.ConsumeAll([&](std::span<const char> record) {
+      matched &= View(record) == data[idx];
+      idx += 1;
+    });
+  }
+  sender_th.join();
+
+  REQUIRE(matched);
+  REQUIRE(ring.IsEmpty());
+}
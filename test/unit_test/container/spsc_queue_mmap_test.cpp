@@ -0,0 +1,357 @@
+#include "hermes/container/spsc_queue_mmap.h"
+
+#include <sys/socket.h>
+#include <sys/wait.h>
+
+#include <catch2/catch_test_macros.hpp>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace hermes::container;
+
+namespace {
+
+struct Order {
+  uint64_t id;
+  double price;
+  int32_t quantity;
+};
+
+struct Tick {
+  explicit Tick(const uint64_t seq) : seq{seq} {}
+  uint64_t seq;
+};
+
+std::string TempPath(const std::string &name) {
+  const auto path = std::filesystem::temp_directory_path() / name;
+  std::filesystem::remove(path);
+  return path.string();
+}
+
+}  // namespace
+
+TEST_CASE("Init Test") {
+  const auto path = TempPath("spsc_queue_mmap_init");
+  {
+    SpscQueueMMap<Order> queue;
+    queue.Init(path, 1 << 16, true);
+
+    // capacity is rounded down to a power of two
+    const auto capacity = queue.Capacity();
+    REQUIRE((capacity & (capacity - 1)) == 0);
+    REQUIRE(capacity * sizeof(Order) <= (1 << 16));
+    REQUIRE(queue.IsEmpty());
+  }
+  std::filesystem::remove(path);
+}
+
+TEST_CASE("Push/Pop Test") {
+  const auto path = TempPath("spsc_queue_mmap_push_pop");
+  {
+    SpscQueueMMap<Order> producer, consumer;
+    producer.Init(path, 4096, true);
+    consumer.Init(path, 4096, false);
+
+    REQUIRE_FALSE(consumer.Pop().has_value());
+
+    uint64_t pushed = 0;
+    while (producer.Push(Order{pushed, 1.5 * pushed, 1})) pushed += 1;
+    REQUIRE(pushed == producer.Capacity());
+
+    for (uint64_t i = 0; i < pushed / 2; ++i) {
+      auto order = consumer.Pop();
+      REQUIRE(order.has_value());
+      REQUIRE(order->id == i);
+    }
+
+    uint64_t expected = pushed / 2;
+    auto count = consumer.ConsumeAll(
+        [&](const Order &order) { REQUIRE(order.id == expected++); });
+    REQUIRE(count == pushed - pushed / 2);
+    REQUIRE(consumer.IsEmpty());
+  }
+  std::filesystem::remove(path);
+}
+
+TEST_CASE("Reattach Test") {
+  const auto path = TempPath("spsc_queue_mmap_reattach");
+  SpscQueueMMap<Order> producer;
+  producer.Init(path, 4096, true);
+  for (uint64_t i = 0; i < 10; ++i) REQUIRE(producer.Push(Order{i, 0, 0}));
+
+  {
+    SpscQueueMMap<Order> consumer;
+    consumer.Init(path, 4096, false);
+    for (uint64_t i = 0; i < 4; ++i) REQUIRE(consumer.Pop()->id == i);
+  }
+
+  // a restarted consumer resumes after the last consumed value
+  SpscQueueMMap<Order> consumer;
+  consumer.Init(path, 4096, false);
+  REQUIRE(consumer.SizeGuess() == 6);
+  REQUIRE(consumer.Pop()->id == 4);
+
+  std::filesystem::remove(path);
+}
+
+TEST_CASE("Cross-process Test") {
+  constexpr uint64_t data_size = 1e5;
+  const auto path = TempPath("spsc_queue_mmap_cross_process");
+
+  SpscQueueMMap<Order> consumer;
+  consumer.Init(path, 1 << 16, true);
+
+  const auto pid = fork();
+  REQUIRE(pid != -1);
+  if (pid == 0) {
+    SpscQueueMMap<Order> producer;
+    producer.Init(path, 1 << 16, false);
+    for (uint64_t i = 0; i < data_size; ++i)
+      while (!producer.Push(Order{i, 0, 0})) {
+      }
+    _exit(0);
+  }
+
+  uint64_t expected = 0;
+  bool ordered = true;
+  while (expected < data_size) {
+    consumer.ConsumeAll(
+        [&](const Order &order) { ordered &= order.id == expected++; });
+  }
+
+  int status;
+  waitpid(pid, &status, 0);
+  REQUIRE(ordered);
+  REQUIRE(WIFEXITED(status));
+
+  std::filesystem::remove(path);
+}
+
+TEST_CASE("Prefault Options Test") {
+  const auto path = TempPath("spsc_queue_mmap_prefault");
+  {
+    SpscQueueMMap<Order> producer;
+    producer.Init(path, 1 << 20, true);
+    for (uint64_t i = 0; i < 10; ++i) REQUIRE(producer.Push(Order{i, 0, 0}));
+
+    MMapOptions options;
+    options.prefault = true;
+    options.lock = true;
+    options.advice = MMapOptions::Advice::SEQUENTIAL;
+
+    // prefaulting a live queue keeps its content
+    SpscQueueMMap<Order> consumer;
+    consumer.Init(path, 1 << 20, false, options);
+    REQUIRE(consumer.PrefaultTime().count() > 0);
+    REQUIRE(consumer.SizeGuess() == 10);
+    for (uint64_t i = 0; i < 10; ++i) REQUIRE(consumer.Pop()->id == i);
+  }
+  std::filesystem::remove(path);
+}
+
+TEST_CASE("Shm Backing Test") {
+  const std::string name = "/hermes_spsc_queue_mmap_shm";
+  shm_unlink(name.c_str());
+  {
+    SpscQueueMMap<Order> producer, consumer;
+    producer.InitShm(name, 4096, true);
+    consumer.InitShm(name, 4096, false);
+    REQUIRE(consumer.Capacity() == producer.Capacity());
+
+    for (uint64_t i = 0; i < 10; ++i) REQUIRE(producer.Push(Order{i, 0, 0}));
+    for (uint64_t i = 0; i < 10; ++i) REQUIRE(consumer.Pop()->id == i);
+    REQUIRE(consumer.IsEmpty());
+  }
+  shm_unlink(name.c_str());
+}
+
+TEST_CASE("Memfd Fd Passing Test") {
+  constexpr uint64_t data_size = 1e5;
+
+  int sockets[2];
+  REQUIRE(socketpair(AF_UNIX, SOCK_STREAM, 0, sockets) == 0);
+
+  const auto pid = fork();
+  REQUIRE(pid != -1);
+  if (pid == 0) {
+    // the producer only knows the socket, the queue fd comes through it
+    close(sockets[0]);
+    const int fd = ReceiveFd(sockets[1]);
+    if (fd == -1) _exit(1);
+
+    SpscQueueMMap<Order> producer;
+    producer.InitFd(fd);
+    for (uint64_t i = 0; i < data_size; ++i)
+      while (!producer.Push(Order{i, 0, 0})) {
+      }
+    _exit(0);
+  }
+  close(sockets[1]);
+
+  SpscQueueMMap<Order> consumer;
+  consumer.InitMemfd("spsc_queue_mmap_memfd", 1 << 16);
+  REQUIRE(SendFd(sockets[0], consumer.Fd()));
+  close(sockets[0]);
+
+  uint64_t expected = 0;
+  bool ordered = true;
+  while (expected < data_size) {
+    consumer.ConsumeAll(
+        [&](const Order &order) { ordered &= order.id == expected++; });
+  }
+
+  int status;
+  waitpid(pid, &status, 0);
+  REQUIRE(ordered);
+  REQUIRE(WIFEXITED(status));
+  REQUIRE(WEXITSTATUS(status) == 0);
+}
+
+TEST_CASE("Empty Fd Attach Test") {
+  // attaching never sizes the file, an empty fd fails instead of becoming a
+  // one element queue, and so does an invalid one
+  SpscQueueMMap<Order> queue;
+  REQUIRE_FALSE(
+      queue.InitFd(memfd_create("spsc_queue_mmap_empty", MFD_CLOEXEC)));
+  REQUIRE_FALSE(queue.InitFd(-1));
+}
+
+TEST_CASE("PopWait Timeout Test") {
+  const auto path = TempPath("spsc_queue_mmap_pop_wait");
+  {
+    SpscQueueMMap<Order, SharedFutexWait> queue;
+    queue.Init(path, 4096, true);
+
+    const auto start = std::chrono::steady_clock::now();
+    REQUIRE_FALSE(queue.PopWait(std::chrono::milliseconds(20)).has_value());
+    REQUIRE(std::chrono::steady_clock::now() - start >=
+            std::chrono::milliseconds(20));
+
+    REQUIRE(queue.Push(Order{7, 0, 0}));
+    REQUIRE(queue.PopWait(std::chrono::milliseconds(20))->id == 7);
+  }
+  std::filesystem::remove(path);
+}
+
+TEST_CASE("Cross-process Futex Wakeup Test") {
+  constexpr uint64_t data_size = 100;
+  const auto path = TempPath("spsc_queue_mmap_futex");
+
+  SpscQueueMMap<Order, SharedFutexWait> consumer;
+  consumer.Init(path, 4096, true);
+
+  const auto pid = fork();
+  REQUIRE(pid != -1);
+  if (pid == 0) {
+    // a low rate producer, the consumer parks between values
+    SpscQueueMMap<Order, SharedFutexWait> producer;
+    producer.Init(path, 4096, false);
+    for (uint64_t i = 0; i < data_size; ++i) {
+      std::this_thread::sleep_for(std::chrono::microseconds(200));
+      producer.Push(Order{i, 0, 0});
+    }
+    _exit(0);
+  }
+
+  bool ordered = true;
+  for (uint64_t i = 0; i < data_size; ++i) {
+    auto order = consumer.PopWait(std::chrono::seconds(5));
+    ordered &= order.has_value() && order->id == i;
+  }
+
+  int status;
+  waitpid(pid, &status, 0);
+  REQUIRE(ordered);
+  REQUIRE(WIFEXITED(status));
+
+  std::filesystem::remove(path);
+}
+
+TEST_CASE("No Default Constructor Pop Test") {
+  const auto path = TempPath("spsc_queue_mmap_no_default");
+  {
+    SpscQueueMMap<Tick> queue;
+    REQUIRE(queue.Init(path, 4096, true));
+    REQUIRE_FALSE(queue.Pop().has_value());
+
+    REQUIRE(queue.Push(Tick{42}));
+    REQUIRE(queue.Pop()->seq == 42);
+  }
+  std::filesystem::remove(path);
+}
+
+TEST_CASE("Unpublished Header Attach Test") {
+  const auto path = TempPath("spsc_queue_mmap_unpublished");
+  std::ofstream(path).close();
+  std::filesystem::resize_file(path, 4096);
+
+  // a sized file whose header never gets published, attach gives up
+  SpscQueueMMap<Order> queue;
+  REQUIRE_FALSE(queue.Init(path, 4096, false));
+
+  std::filesystem::remove(path);
+}
+
+TEST_CASE("Late Header Attach Test") {
+  const auto path = TempPath("spsc_queue_mmap_late_header");
+  std::ofstream(path).close();
+  std::filesystem::resize_file(path, 4096);
+
+  // the consumer maps the file before the producer wrote the header
+  SpscQueueMMap<Order> consumer;
+  bool attached = false;
+  std::thread consumer_th(
+      [&]() { attached = consumer.Init(path, 4096, false); });
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  SpscQueueMMap<Order> producer;
+  REQUIRE(producer.Init(path, 4096, true));
+  consumer_th.join();
+
+  REQUIRE(attached);
+  REQUIRE(producer.Push(Order{3, 0, 0}));
+  REQUIRE(consumer.Pop()->id == 3);
+
+  std::filesystem::remove(path);
+}
+
+TEST_CASE("Concurrent Create Test") {
+  constexpr int queue_count = 8;
+  const auto path = TempPath("spsc_queue_mmap_concurrent_create");
+
+  // every process opening a new file at once, exactly one writes the header
+  // and the rest attach to it
+  SpscQueueMMap<Order> queues[queue_count];
+  bool attached[queue_count] = {};
+  std::vector<std::thread> threads;
+  for (auto i = 0; i < queue_count; ++i)
+    threads.emplace_back(
+        [&, i]() { attached[i] = queues[i].Init(path, 4096, false); });
+  for (auto &thread : threads) thread.join();
+
+  for (auto i = 0; i < queue_count; ++i) REQUIRE(attached[i]);
+  REQUIRE(queues[0].Push(Order{11, 0, 0}));
+  for (auto i = 1; i < queue_count; ++i) REQUIRE(queues[i].SizeGuess() == 1);
+  REQUIRE(queues[queue_count - 1].Pop()->id == 11);
+
+  std::filesystem::remove(path);
+}
+
+TEST_CASE("Header Mismatch Attach Test") {
+  const auto path = TempPath("spsc_queue_mmap_mismatch");
+  {
+    SpscQueueMMap<Order> queue;
+    REQUIRE(queue.Init(path, 4096, true));
+
+    // a different element type or wait strategy fails the attach
+    SpscQueueMMap<uint32_t> other_type;
+    REQUIRE_FALSE(other_type.Init(path, 4096, false));
+    SpscQueueMMap<Order, SharedFutexWait> other_wait;
+    REQUIRE_FALSE(other_wait.Init(path, 4096, false));
+  }
+  std::filesystem::remove(path);
+}
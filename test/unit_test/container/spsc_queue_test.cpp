@@ -17,7 +17,7 @@ TEST_CASE("Sequential Write Test") {
 
   SpscQueue<int, data_size> queue;
   for (auto i = 0; i < data_size; ++i) {
-    const auto val = IRand::RandInt32(0, data_size);
+    const auto val = IRand::RandT<int32_t>(0, data_size);
     data.push_back(val);
     queue.Write(val);
   }
@@ -39,7 +39,7 @@ TEST_CASE("Multi-thread Write/Read Test") {
   std::vector<int> data;
 
   for (uint32_t i = 0; i < data_size; ++i) {
-    const auto val = IRand::RandInt32(0, data_size);
+    const auto val = IRand::RandT<int32_t>(0, data_size);
     data.push_back(val);
   }
 
@@ -66,3 +66,274 @@ TEST_CASE("Multi-thread Write/Read Test") {
   });
   receiver_th.join();
 }
+
+TEST_CASE("ConsumeOne Test") {
+  SpscQueue<int, 4> queue;
+  REQUIRE_FALSE(queue.ConsumeOne([](int &) {}));
+
+  for (auto i = 0; i < 4; ++i) REQUIRE(queue.Write(i));
+  REQUIRE_FALSE(queue.Write(4));
+
+  for (auto i = 0; i < 4; ++i) {
+    int val = -1;
+    REQUIRE(queue.ConsumeOne([&](int &v) { val = v; }));
+    REQUIRE(val == i);
+  }
+  REQUIRE(queue.IsEmpty());
+}
+
+TEST_CASE("ConsumeAll Wraparound Test") {
+  constexpr uint32_t queue_size = 8;
+  SpscQueue<int, queue_size> queue;
+
+  int expected = 0, next = 0;
+  for (auto round = 0; round < 10; ++round) {
+    // write a batch that crosses the end of the ring
+    for (auto i = 0; i < 5; ++i) REQUIRE(queue.Write(next++));
+
+    auto count = queue.ConsumeAll([&](int &v) {
+      REQUIRE(v == expected);
+      expected += 1;
+    });
+    REQUIRE(count == 5);
+    REQUIRE(queue.IsEmpty());
+  }
+  REQUIRE(queue.ConsumeAll([](int &) {}) == 0);
+}
+
+TEST_CASE("Multi-thread ConsumeAll Test") {
+  constexpr uint32_t data_size = 1e5;
+  SpscQueue<uint32_t, 1024> queue;
+
+  std::thread sender_th([&]() {
+    for (uint32_t i = 0; i < data_size; ++i)
+      while (!queue.Write(i)) {
+      }
+  });
+
+  uint32_t idx = 0;
+  bool ordered = true;
+  while (idx < data_size) {
+    queue.ConsumeAll([&](uint32_t &v) {
+      ordered &= v == idx;
+      idx += 1;
+    });
+  }
+  sender_th.join();
+
+  REQUIRE(ordered);
+  REQUIRE(queue.IsEmpty());
+}
+
+TEST_CASE("Claim/Commit Peek/Release Test") {
+  SpscQueue<int, 6> queue;
+  REQUIRE(queue.Peek(4).empty());
+
+  auto slots = queue.Claim(4);
+  REQUIRE(slots.size() == 4);
+  for (auto i = 0; i < 4; ++i) new (&slots[i]) int{i};
+
+  // nothing is visible before commit
+  REQUIRE(queue.Peek(4).empty());
+  queue.Commit(4);
+  REQUIRE(queue.SizeGuess() == 4);
+
+  auto values = queue.Peek(8);
+  REQUIRE(values.size() == 4);
+  for (auto i = 0; i < 4; ++i) REQUIRE(values[i] == i);
+  queue.Release(3);
+  REQUIRE(queue.SizeGuess() == 1);
+
+  // only 3 slots left before the end of the ring
+  slots = queue.Claim(5);
+  REQUIRE(slots.size() == 3);
+  for (auto i = 0; i < 3; ++i) new (&slots[i]) int{4 + i};
+  queue.Commit(3);
+
+  // the rest wraps to the front, one slot is kept free by the ring
+  slots = queue.Claim(5);
+  REQUIRE(slots.size() == 2);
+  new (&slots[0]) int{7};
+  queue.Commit(1);
+
+  REQUIRE(queue.Claim(5).size() == 1);
+
+  std::vector<int> result;
+  while (true) {
+    auto peek = queue.Peek(16);
+    if (peek.empty()) break;
+    for (auto v : peek) result.push_back(v);
+    queue.Release(peek.size());
+  }
+  REQUIRE(result == std::vector<int>{3, 4, 5, 6, 7});
+}
+
+TEST_CASE("Multi-thread Claim/Peek Test") {
+  constexpr uint32_t data_size = 1e5;
+  SpscQueue<uint32_t, 1000> queue;
+
+  std::thread sender_th([&]() {
+    uint32_t next = 0;
+    while (next < data_size) {
+      auto slots = queue.Claim(std::min<uint32_t>(64, data_size - next));
+      for (auto &slot : slots) new (&slot) uint32_t{next++};
+      queue.Commit(slots.size());
+    }
+  });
+
+  uint32_t idx = 0;
+  bool ordered = true;
+  while (idx < data_size) {
+    auto values = queue.Peek(128);
+    for (auto v : values) ordered &= v == idx++;
+    queue.Release(values.size());
+  }
+  sender_th.join();
+
+  REQUIRE(ordered);
+  REQUIRE(queue.IsEmpty());
+}
+
+TEST_CASE("Power of Two Capacity Test") {
+  SpscQueue<int, 4> queue;
+
+  // every slot is usable when the capacity is a power of two
+  int expected = 0, next = 0;
+  for (auto round = 0; round < 100; ++round) {
+    for (auto i = 0; i < 4; ++i) {
+      REQUIRE(queue.Write(next++));
+      REQUIRE(queue.SizeGuess() == size_t(i + 1));
+    }
+    REQUIRE_FALSE(queue.WriteAvailable());
+    REQUIRE_FALSE(queue.Write(next));
+
+    for (auto i = 0; i < 3; ++i) {
+      int val;
+      REQUIRE(queue.Read(val));
+      REQUIRE(val == expected++);
+    }
+    REQUIRE(queue.SizeGuess() == 1);
+
+    REQUIRE(queue.ConsumeAll([&](int &v) { REQUIRE(v == expected++); }) == 1);
+  }
+
+  // claims stop at the end of the ring
+  REQUIRE(queue.Claim(4).size() == 4);
+  queue.Commit(0);
+  REQUIRE(queue.Write(next++));
+  REQUIRE(queue.Claim(4).size() == 3);
+}
+
+TEST_CASE("ReadWait Timeout Test") {
+  using namespace std::chrono_literals;
+
+  SpscQueue<int, 16, PauseSpinWait> spin_queue;
+  int val;
+  REQUIRE_FALSE(spin_queue.ReadWait(val, 1ms));
+  REQUIRE(spin_queue.Write(7));
+  REQUIRE(spin_queue.ReadWait(val, 1ms));
+  REQUIRE(val == 7);
+
+  SpscQueue<int, 16, FutexWait> futex_queue;
+  REQUIRE_FALSE(futex_queue.ReadWait(1ms).has_value());
+  REQUIRE(futex_queue.Write(8));
+  REQUIRE(futex_queue.ReadWait(1ms) == 8);
+}
+
+template <typename Queue>
+void RunReadWait() {
+  using namespace std::chrono_literals;
+  constexpr uint32_t data_size = 1e5;
+  Queue queue;
+
+  std::thread sender_th([&]() {
+    for (uint32_t i = 0; i < data_size; ++i) {
+      while (!queue.Write(i)) {
+      }
+      // let the consumer park from time to time
+      if (i % 10000 == 0) std::this_thread::sleep_for(1ms);
+    }
+  });
+
+  uint32_t idx = 0, val;
+  bool ordered = true;
+  while (idx < data_size) {
+    if (queue.ReadWait(val, 1s)) ordered &= val == idx++;
+  }
+  sender_th.join();
+
+  REQUIRE(ordered);
+}
+
+TEST_CASE("Multi-thread ReadWait Test") {
+  RunReadWait<SpscQueue<uint32_t, 1024, BusySpinWait>>();
+  RunReadWait<SpscQueue<uint32_t, 1024, PauseSpinWait>>();
+  RunReadWait<SpscQueue<uint32_t, 1024, SpinYieldWait>>();
+  RunReadWait<SpscQueue<uint32_t, 1024, FutexWait>>();
+}
+
+TEST_CASE("Ring Memory Options Test") {
+  RingMemoryOptions options;
+  options.huge_pages = true;
+  options.prefault = true;
+  options.numa_node = RingMemoryOptions::CurrentNumaNode();
+
+  // falls back to normal pages when no huge pages are available
+  SpscQueue<uint64_t, 1 << 20> queue{options};
+  for (uint64_t round = 0; round < 3; ++round) {
+    for (uint64_t i = 0; i < queue.Capacity(); ++i) REQUIRE(queue.Write(i));
+    REQUIRE_FALSE(queue.Write(uint64_t{0}));
+
+    uint64_t expected = 0;
+    bool ordered = true;
+    queue.ConsumeAll([&](uint64_t &v) { ordered &= v == expected++; });
+    REQUIRE(ordered);
+    REQUIRE(expected == queue.Capacity());
+  }
+}
+
+TEST_CASE("Instrumentation Test") {
+  SpscQueue<int, 16, BusySpinWait, TscQueueInstrumentation> queue;
+  for (auto i = 0; i < 10; ++i) REQUIRE(queue.Write(i));
+
+  int val;
+  REQUIRE(queue.Read(val));
+  REQUIRE(queue.ConsumeOne([](int &) {}));
+  REQUIRE(queue.ConsumeAll([](int &) {}) == 8);
+
+  const auto &stats = queue.Stats();
+  REQUIRE(stats.HighWaterMark() == 10);
+  REQUIRE(stats.Residency().TotalCount() == 10);
+  REQUIRE(stats.Residency().Percentile(1.0) >=
+          stats.Residency().Percentile(0.5));
+
+  auto slots = queue.Claim(4);
+  for (auto &slot : slots) new (&slot) int{0};
+  queue.Commit(slots.size());
+  queue.Release(queue.Peek(4).size());
+  REQUIRE(stats.Residency().TotalCount() == 10 + slots.size());
+  REQUIRE(stats.HighWaterMark() == 10);
+}
+
+TEST_CASE("Instrumentation High Water Mark Test") {
+  SpscQueue<int, 1024, BusySpinWait, TscQueueInstrumentation> queue;
+  for (auto i = 0; i < 5000; ++i) {
+    int val;
+    REQUIRE(queue.Write(i));
+    REQUIRE(queue.Read(val));
+  }
+
+  REQUIRE(queue.Stats().HighWaterMark() == 1);
+}
+
+TEST_CASE("Latency Histogram Test") {
+  LatencyHistogram histogram;
+  REQUIRE(histogram.Percentile(0.5) == 0);
+
+  for (uint64_t i = 1; i <= 100; ++i) histogram.Record(i);
+  histogram.Record(1 << 20);
+
+  REQUIRE(histogram.TotalCount() == 101);
+  REQUIRE(histogram.Percentile(0.5) == 63);
+  REQUIRE(histogram.Percentile(1.0) == (1 << 21) - 1);
+}
@@ -27,3 +27,45 @@ TEST_CASE("PushBack PopBack Test") {
 
   REQUIRE(vi.Back() == data[0]);
 }
+
+TEST_CASE("Reserve Resize Test") {
+  auto vi = Vector<int>();
+  vi.PushBack(7);
+
+  vi.Reserve(100);
+  REQUIRE(vi.MaxSize() == 100);
+  REQUIRE(vi.Back() == 7);
+
+  vi.Resize(50);
+  REQUIRE(vi.Size() == 50);
+  REQUIRE(vi.MaxSize() == 100);
+  REQUIRE(vi[0] == 7);
+
+  vi.Resize(1);
+  REQUIRE(vi.Size() == 1);
+  REQUIRE(vi.Back() == 7);
+
+  // growing by push back keeps doubling
+  for (auto i = 0; i < 200; ++i) vi.PushBack(i);
+  REQUIRE(vi.Size() == 201);
+  REQUIRE(vi.Back() == 199);
+}
+
+TEST_CASE("Empty Destruction Test") {
+  // an empty vector, e.g. ReadAll of an empty file, destroys nothing
+  { auto vi = Vector<int>(); }
+
+  {
+    auto vi = Vector<int>();
+    vi.Resize(0);
+    REQUIRE(vi.IsEmpty());
+  }
+
+  // a moved-from vector is left empty
+  auto vi = Vector<int>();
+  vi.PushBack(3);
+  REQUIRE_FALSE(vi.IsEmpty());
+  auto moved = std::move(vi);
+  REQUIRE(vi.IsEmpty());
+  REQUIRE(moved.Back() == 3);
+}
@@ -0,0 +1,64 @@
+#include "hermes/container/unbounded_spsc_queue.h"
+
+#include <catch2/catch_test_macros.hpp>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace hermes::container;
+
+TEST_CASE("Init Test") { UnboundedSpscQueue<int> queue{4}; }
+
+TEST_CASE("Sequential Write Test") {
+  UnboundedSpscQueue<int, 8> queue;
+  REQUIRE(queue.IsEmpty());
+  REQUIRE_FALSE(queue.Read().has_value());
+
+  // spans many chunks
+  for (auto i = 0; i < 1000; ++i) queue.Write(i);
+  REQUIRE(queue.SizeGuess() == 1000);
+
+  for (auto i = 0; i < 1000; ++i) {
+    int val;
+    REQUIRE(queue.Read(val));
+    REQUIRE(val == i);
+  }
+  REQUIRE(queue.IsEmpty());
+}
+
+TEST_CASE("Chunk Recycling Test") {
+  UnboundedSpscQueue<std::unique_ptr<int>, 4, 2> queue;
+
+  for (auto round = 0; round < 100; ++round) {
+    for (auto i = 0; i < 10; ++i) queue.Write(std::make_unique<int>(i));
+
+    int expected = 0;
+    auto count = queue.ConsumeAll([&](std::unique_ptr<int> &v) {
+      REQUIRE(*v == expected++);
+    });
+    REQUIRE(count == 10);
+  }
+
+  // values left in the queue are destroyed with it
+  queue.Write(std::make_unique<int>(0));
+}
+
+TEST_CASE("Multi-thread Write/ConsumeAll Test") {
+  constexpr uint64_t data_size = 1e6;
+  UnboundedSpscQueue<uint64_t, 256> queue;
+
+  std::thread sender_th([&]() {
+    for (uint64_t i = 0; i < data_size; ++i) queue.Write(i);
+  });
+
+  uint64_t idx = 0;
+  bool ordered = true;
+  while (idx < data_size) {
+    queue.ConsumeAll([&](uint64_t &v) { ordered &= v == idx++; });
+  }
+  sender_th.join();
+
+  REQUIRE(ordered);
+  REQUIRE(queue.IsEmpty());
+}
@@ -0,0 +1,429 @@
+#include "hermes/io/fastio.h"
+#include "hermes/io/parallel_fastio.h"
+
+#include <algorithm>
+#include <catch2/catch_test_macros.hpp>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "hermes/random/random.h"
+
+using namespace hermes::io;
+using namespace hermes::random;
+
+namespace {
+
+std::string TempPath(const std::string &name) {
+  const auto path = std::filesystem::temp_directory_path() / name;
+  std::filesystem::remove(path);
+  return path.string();
+}
+
+// Values of every digit count from 1 to 20, separated by a space or a new
+// line
+std::vector<uint64_t> WriteData(const std::string &path, const int count) {
+  std::vector<uint64_t> data;
+  std::ofstream out(path);
+  for (auto i = 0; i < count; ++i) {
+    const auto value = IntegralRandom::RandT<uint64_t>() >> (i % 64);
+    data.push_back(value);
+    out << value << (IntegralRandom::RandT<uint32_t>() % 2 ? ' ' : '\n');
+  }
+  return data;
+}
+
+}  // namespace
+
+TEST_CASE("Parse Digits Test") {
+  // every run length against the scalar parser, followed by a separator and
+  // garbage the vector load also sees
+  std::string digits = "1234567890123456";
+  for (auto len = 0; len <= detail::SIMD_DIGITS; ++len) {
+    const auto text = digits.substr(0, len) + " 99999999999999999";
+
+    uint64_t expected;
+    REQUIRE(detail::ParseDigitsScalar(text.data(), text.data() + text.size(),
+                                      expected) == len);
+
+    uint64_t value = 0;
+    REQUIRE(detail::ParseDigitsSimd(text.data(), value) == len);
+    REQUIRE(value == expected);
+  }
+
+  // runs longer than a vector finish one character at a time
+  const std::string text = "18446744073709551615 1";
+  uint64_t value;
+  REQUIRE(detail::ParseDigitRun(text.data(), text.data() + text.size(),
+                                value) == 20);
+  REQUIRE(value == 18446744073709551615ull);
+  REQUIRE(detail::ParseDigitRun(text.data(), text.data() + 20, value) == -1);
+}
+
+TEST_CASE("ReadOne Test") {
+  constexpr int data_size = 1e5;
+  const auto path = TempPath("fastio_read_one");
+  const auto data = WriteData(path, data_size);
+
+  // a small window puts many values across window boundaries
+  FastIOOptions options;
+  options.max_mapping_size = 0;
+  IntegralFastIO<uint64_t, 1 << 12> reader;
+  reader.Init(path.c_str(), options);
+  REQUIRE(reader.IsGood());
+
+  for (auto i = 0; i < data_size; ++i) REQUIRE(reader.ReadOne() == data[i]);
+
+  reader.ReadOne();
+  REQUIRE_FALSE(reader.IsGood());
+  std::filesystem::remove(path);
+}
+
+TEST_CASE("Whole File Mapping Test") {
+  constexpr int data_size = 1e5;
+  const auto path = TempPath("fastio_whole_file");
+  const auto data = WriteData(path, data_size);
+
+  FastIOOptions options;
+  options.huge_pages = true;
+
+  IntegralFastIO<uint64_t> whole, windowed;
+  whole.Init(path.c_str(), options);
+  options.max_mapping_size = 0;
+  windowed.Init(path.c_str(), options);
+
+  for (auto i = 0; i < data_size; ++i) {
+    REQUIRE(whole.ReadOne() == data[i]);
+    REQUIRE(windowed.ReadOne() == data[i]);
+  }
+
+  whole.ReadOne();
+  REQUIRE_FALSE(whole.IsGood());
+  std::filesystem::remove(path);
+}
+
+TEST_CASE("ReadMany Test") {
+  constexpr int data_size = 1e5;
+  const auto path = TempPath("fastio_read_many");
+  const auto data = WriteData(path, data_size);
+
+  FastIOOptions options;
+  options.max_mapping_size = 0;
+  IntegralFastIO<uint64_t, 1 << 12> reader;
+  reader.Init(path.c_str(), options);
+
+  // odd block sizes end blocks in the middle of windows
+  std::vector<uint64_t> values(data_size + 10);
+  size_t count = 0;
+  for (size_t block = 1; count < data_size; block = block * 3 + 1) {
+    const auto read = reader.ReadMany(values.data() + count, block);
+    count += read;
+    if (read < block) break;
+  }
+  REQUIRE(count == data_size);
+  values.resize(count);
+  REQUIRE(values == data);
+
+  // nothing left, the trailing separator is not a value
+  REQUIRE(reader.ReadMany(values.data(), 10) == 0);
+  REQUIRE_FALSE(reader.IsGood());
+  std::filesystem::remove(path);
+}
+
+TEST_CASE("ReadAll Test") {
+  const auto path = TempPath("fastio_read_all");
+  {
+    std::ofstream out(path);
+    out << "-5 17 -123456789012345 0\n42";
+  }
+
+  hermes::container::Vector<int64_t> values;
+  values.PushBack(1);
+
+  IntegralFastIO<int64_t> reader;
+  reader.Init(path.c_str());
+  REQUIRE(reader.ReadAll(values) == 5);
+  REQUIRE_FALSE(reader.IsGood());
+
+  const int64_t expected[] = {1, -5, 17, -123456789012345, 0, 42};
+  REQUIRE(values.Size() == 6);
+  for (auto i = 0; i < 6; ++i) REQUIRE(values[i] == expected[i]);
+
+  std::filesystem::remove(path);
+}
+
+TEST_CASE("ReadOne Narrow Type Test") {
+  const auto path = TempPath("fastio_read_one_narrow");
+  {
+    std::ofstream out(path);
+    out << "0 7 42\n65535 4294967295 123";
+  }
+
+  IntegralFastIO<uint32_t> reader;
+  reader.Init(path.c_str());
+  for (const uint32_t value : {0u, 7u, 42u, 65535u, 4294967295u, 123u})
+    REQUIRE(reader.ReadOne() == value);
+
+  std::filesystem::remove(path);
+}
+
+TEST_CASE("ReadOne Signed Test") {
+  const auto path = TempPath("fastio_read_one_signed");
+  const std::vector<int64_t> data = {
+      0, -1, 1, -42, 1234567890123456789, -1234567890123456789,
+      std::numeric_limits<int64_t>::max(), std::numeric_limits<int64_t>::min(),
+      -7, -1234567, 99};
+  {
+    std::ofstream out(path);
+    // pad so the values are read both with and without the vector path
+    for (auto i = 0; i < 3; ++i)
+      for (const auto value : data) out << value << ' ';
+  }
+
+  IntegralFastIO<int64_t> reader;
+  reader.Init(path.c_str());
+  for (auto i = 0; i < 3; ++i)
+    for (const auto value : data) REQUIRE(reader.ReadOne() == value);
+
+  std::filesystem::remove(path);
+}
+
+TEST_CASE("Parse Float Test") {
+  const auto check = [](const std::string &text) {
+    const auto token = text + " ";
+
+    double value;
+    REQUIRE(detail::ParseFloat(token.data(), token.data() + token.size(),
+                               value) == int(text.size()));
+    const auto expected = std::strtod(text.c_str(), nullptr);
+    INFO(text);
+    REQUIRE(std::memcmp(&value, &expected, sizeof(double)) == 0);
+
+    float value_f;
+    detail::ParseFloat(token.data(), token.data() + token.size(), value_f);
+    const auto expected_f = std::strtof(text.c_str(), nullptr);
+    REQUIRE(std::memcmp(&value_f, &expected_f, sizeof(float)) == 0);
+  };
+
+  // exact, halfway, subnormal, overflow and long mantissa cases
+  for (const auto *text :
+       {"0", "-0", "1", "-1.5", "0.1", "123.4567", "+2.5e3", "1e22", "1e23",
+        "9007199254740993", "2.2250738585072011e-308", "4.9e-324", "2e-324",
+        "1e-400", "1.7976931348623157e308", "1e309", "-1e309",
+        "0.000000000000000000000000123", "123456789012345678901234567890",
+        "7.038531e-26", "3.4028235e38", "1.4e-45", "0.30000000000000004",
+        "2.5E-5", "1.00000000000000011102230246251565404236316680908203125"})
+    check(text);
+
+  // random bit patterns printed with the shortest exact representation
+  char text[64];
+  for (auto i = 0; i < 100000; ++i) {
+    // two draws, RandT goes through a double and leaves low bits zero
+    const auto bits = uint64_t(IntegralRandom::RandT<uint32_t>()) << 32 |
+                      IntegralRandom::RandT<uint32_t>();
+    double value;
+    std::memcpy(&value, &bits, sizeof(double));
+    if (value != value || value - value != 0) continue;
+
+    std::snprintf(text, sizeof(text), "%.17g", value);
+    check(text);
+    std::snprintf(text, sizeof(text), "%.6g", value);
+    check(text);
+  }
+
+  // prices
+  for (auto i = 0; i < 100000; ++i) {
+    std::snprintf(text, sizeof(text), "%u.%04u",
+                  IntegralRandom::RandT<uint32_t>() % 100000,
+                  IntegralRandom::RandT<uint32_t>() % 10000);
+    check(text);
+  }
+}
+
+TEST_CASE("Float ReadOne Test") {
+  constexpr int data_size = 1e5;
+  const auto path = TempPath("fastio_float_read_one");
+
+  std::vector<double> data;
+  {
+    char text[64];
+    std::ofstream out(path);
+    for (auto i = 0; i < data_size; ++i) {
+      // explicit bounds, RandT takes right - left in T and the difference
+      // must fit in int64_t
+      const auto mantissa =
+          IntegralRandom::RandT<int64_t>(-(1ll << 61), 1ll << 61) >> (i % 60);
+      std::snprintf(text, sizeof(text), "%.*g", 1 + i % 17, mantissa * 1e-4);
+      data.push_back(std::strtod(text, nullptr));
+      out << text << (i % 2 ? ' ' : '\n');
+    }
+  }
+
+  const auto positive = [](double v) { return v > 1; };
+  const auto negative = [](double v) { return v < -1; };
+  REQUIRE(std::any_of(data.begin(), data.end(), positive));
+  REQUIRE(std::any_of(data.begin(), data.end(), negative));
+
+  // a small window puts many values across window boundaries
+  FastIOOptions options;
+  options.max_mapping_size = 0;
+  FloatFastIO<double, 1 << 12> reader;
+  reader.Init(path.c_str(), options);
+  for (auto i = 0; i < data_size; ++i) REQUIRE(reader.ReadOne() == data[i]);
+
+  // a parser stopping inside a token and repeated separators, whole file
+  // mapped and across window boundaries
+  {
+    std::ofstream out(path);
+    for (auto i = 0; i < 1000; ++i) out << "1e 2  3.5\n\n-4 \t1.25e ";
+    out << "7";
+  }
+  for (const size_t max_mapping_size : {size_t(1) << 32, size_t(0)}) {
+    options.max_mapping_size = max_mapping_size;
+    FloatFastIO<double, 1 << 12> tokens;
+    tokens.Init(path.c_str(), options);
+    for (auto i = 0; i < 1000; ++i) {
+      REQUIRE(tokens.ReadOne() == 1);
+      REQUIRE(tokens.ReadOne() == 2);
+      REQUIRE(tokens.ReadOne() == 3.5);
+      REQUIRE(tokens.ReadOne() == -4);
+      REQUIRE(tokens.ReadOne() == 1.25);
+    }
+    REQUIRE(tokens.ReadOne() == 7);
+    REQUIRE(!tokens.IsGood());
+  }
+
+  // separators other than whitespace, each letter reads as 0
+  {
+    std::ofstream out(path);
+    for (auto i = 0; i < 1000; ++i) out << "1.5,2.5;-3|nan 4\n";
+  }
+  for (const size_t max_mapping_size : {size_t(1) << 32, size_t(0)}) {
+    options.max_mapping_size = max_mapping_size;
+    FloatFastIO<double, 1 << 12> tokens;
+    tokens.Init(path.c_str(), options);
+    for (auto i = 0; i < 1000; ++i) {
+      REQUIRE(tokens.IsGood());
+      REQUIRE(tokens.ReadOne() == 1.5);
+      REQUIRE(tokens.ReadOne() == 2.5);
+      REQUIRE(tokens.ReadOne() == -3);
+      for (auto j = 0; j < 3; ++j) REQUIRE(tokens.ReadOne() == 0);
+      REQUIRE(tokens.ReadOne() == 4);
+    }
+    REQUIRE(!tokens.IsGood());
+  }
+
+  std::filesystem::remove(path);
+}
+
+TEST_CASE("Repeated Separators Test") {
+  const auto path = TempPath("fastio_repeated_separators");
+  {
+    std::ofstream out(path);
+    for (auto i = 0; i < 1000; ++i) out << "1  2\n\n3, 4,,5 \t-6\n";
+    out << "7";
+  }
+
+  // one separator character, then whitespace is skipped, in every reader
+  std::vector<int64_t> expected;
+  for (auto i = 0; i < 1000; ++i)
+    for (const int64_t value : {1, 2, 3, 4, 0, 5, -6})
+      expected.push_back(value);
+  expected.push_back(7);
+
+  FastIOOptions options;
+  for (const size_t max_mapping_size : {size_t(1) << 32, size_t(0)}) {
+    options.max_mapping_size = max_mapping_size;
+
+    IntegralFastIO<int64_t, 1 << 12> integers;
+    integers.Init(path.c_str(), options);
+    for (const auto value : expected) REQUIRE(integers.ReadOne() == value);
+    REQUIRE(!integers.IsGood());
+
+    FloatFastIO<double, 1 << 12> floats;
+    floats.Init(path.c_str(), options);
+    for (const auto value : expected) REQUIRE(floats.ReadOne() == value);
+    REQUIRE(!floats.IsGood());
+  }
+
+  for (const size_t thread_count : {1, 3, 7}) {
+    ParallelFastIO<int64_t> parallel;
+    parallel.Init(path.c_str());
+
+    hermes::container::Vector<int64_t> values;
+    REQUIRE(parallel.ReadAll(values, thread_count) == expected.size());
+    for (size_t i = 0; i < expected.size(); ++i)
+      REQUIRE(values[i] == expected[i]);
+  }
+
+  std::filesystem::remove(path);
+}
+
+TEST_CASE("Parallel ReadAll Test") {
+  const auto path = TempPath("fastio_parallel");
+  {
+    // signed values of every length, single and repeated separators
+    std::ofstream out(path);
+    for (auto i = 0; i < 100000; ++i) {
+      // explicit bounds, RandT takes right - left in T and the difference
+      // must fit in int64_t
+      const auto value =
+          IntegralRandom::RandT<int64_t>(-(1ll << 61), 1ll << 61) >> (i % 64);
+      out << value << (i % 3 ? " " : "\n");
+      if (i % 1000 == 0) out << ' ';
+    }
+    out << -42;
+  }
+
+  hermes::container::Vector<int64_t> expected;
+  IntegralFastIO<int64_t> reader;
+  reader.Init(path.c_str());
+  reader.ReadAll(expected);
+
+  // chunk boundaries land before both signed and unsigned digit runs
+  const auto *begin = expected.Data(), *end = begin + expected.Size();
+  REQUIRE(std::any_of(begin, end, [](int64_t v) { return v > 1000; }));
+  REQUIRE(std::any_of(begin, end, [](int64_t v) { return v < -1000; }));
+
+  for (const size_t thread_count : {1, 2, 3, 7, 64}) {
+    ParallelFastIO<int64_t> parallel;
+    parallel.Init(path.c_str());
+
+    hermes::container::Vector<int64_t> values;
+    REQUIRE(parallel.ReadAll(values, thread_count) == expected.Size());
+    REQUIRE(values.Size() == expected.Size());
+    REQUIRE(std::memcmp(values.Data(), expected.Data(),
+                        expected.Size() * sizeof(int64_t)) == 0);
+
+    // chunks concatenate to the same values
+    const auto chunks = parallel.ReadChunks(thread_count);
+    REQUIRE(chunks.size() == thread_count);
+    size_t offset = 0;
+    for (const auto &chunk : chunks) {
+      for (size_t i = 0; i < chunk.Size(); ++i)
+        REQUIRE(chunk[i] == expected[offset + i]);
+      offset += chunk.Size();
+    }
+    REQUIRE(offset == expected.Size());
+  }
+
+  std::filesystem::remove(path);
+}
+
+TEST_CASE("Parallel Empty File Test") {
+  const auto path = TempPath("fastio_parallel_empty");
+  std::ofstream(path).close();
+
+  ParallelFastIO<uint32_t> parallel;
+  parallel.Init(path.c_str());
+
+  hermes::container::Vector<uint32_t> values;
+  REQUIRE(parallel.ReadAll(values, 4) == 0);
+  REQUIRE(values.Size() == 0);
+
+  std::filesystem::remove(path);
+}